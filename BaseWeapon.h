@@ -7,6 +7,14 @@
 class USkeletalMeshComponent;
 class UParticleSystem;
 
+/* The actions a weapon can perform, used to queue up input for the weapon and to send it to the server */
+UENUM()
+enum class EWeaponAction : uint8
+{
+	Primary,
+	Secondary
+};
+
 /* Base class of all weapon actors*/
 UCLASS(Abstract)
 class GRAVITYGUNPROJECT_API ABaseWeapon : public AActor
@@ -24,10 +32,22 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
 	bool bShouldDebugTraces = false;
 
+	/* Minimum time in seconds between two of the same action, i.e. the fire rate of the weapon */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
+	float PrimaryActionCooldown = 0.1f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
+	float SecondaryActionCooldown = 0.1f;
+
 protected:
 	// If the weapon behavior requires a trace, this component is set by the weapon owner to specify the starting location and direction for the trace 
 	USceneComponent * TraceComponent;
 
+	// Time at which the action being performed was issued by a remote client, negative when it is happening now
+	// This is server world time, i.e. the client's AGameStateBase::GetServerWorldTimeSeconds() when it pressed the button,
+	// which is the clock the rewind history is recorded against. Set by the action queue around a client's action on the server
+	float ActionTimestamp = -1.0f;
+
 	/* These are triggered after their respective actions are performed*/
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
 	USoundBase* PrimaryActionSound;
@@ -60,6 +80,10 @@ public:
 
 	FORCEINLINE USceneComponent * GetTraceComponent() { return TraceComponent; }
 
+	FORCEINLINE float GetActionCooldown(EWeaponAction action) const { return action == EWeaponAction::Primary ? PrimaryActionCooldown : SecondaryActionCooldown; }
+
+	FORCEINLINE void SetActionTimestamp(float newActionTimestamp) { ActionTimestamp = newActionTimestamp; }
+
 protected:
 
 	// Begin AActor interface ------
@@ -0,0 +1,189 @@
+#include "GrabComponentPool.h"
+#include "GravityGun.h"
+#include "GravityGunWorldManager.h"
+#include "PhysicsEngine/PhysicsHandleComponent.h"
+#include "Components/SplineMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/ArchiveCountMem.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGrabComponentPool, Log, All);
+
+FGrabHandleSettings FGrabHandleSettings::FromHandle(const UPhysicsHandleComponent * physicsHandle)
+{
+	FGrabHandleSettings settings;
+	settings.bSoftAngularConstraint = physicsHandle->bSoftAngularConstraint;
+	settings.bSoftLinearConstraint = physicsHandle->bSoftLinearConstraint;
+	settings.bInterpolateTarget = physicsHandle->bInterpolateTarget;
+	settings.LinearDamping = physicsHandle->LinearDamping;
+	settings.LinearStiffness = physicsHandle->LinearStiffness;
+	settings.AngularDamping = physicsHandle->AngularDamping;
+	settings.AngularStiffness = physicsHandle->AngularStiffness;
+	settings.InterpolationSpeed = physicsHandle->InterpolationSpeed;
+	return settings;
+}
+
+void FGrabHandleSettings::ApplyTo(UPhysicsHandleComponent * physicsHandle) const
+{
+	physicsHandle->bSoftAngularConstraint = bSoftAngularConstraint;
+	physicsHandle->bSoftLinearConstraint = bSoftLinearConstraint;
+	physicsHandle->bInterpolateTarget = bInterpolateTarget;
+	physicsHandle->LinearDamping = LinearDamping;
+	physicsHandle->LinearStiffness = LinearStiffness;
+	physicsHandle->AngularDamping = AngularDamping;
+	physicsHandle->AngularStiffness = AngularStiffness;
+	physicsHandle->InterpolationSpeed = InterpolationSpeed;
+}
+
+AGrabComponentPool * AGrabComponentPool::Get(UWorld * world)
+{
+	return GetOrSpawnWorldManager<AGrabComponentPool>(world);
+}
+
+void AGrabComponentPool::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Create the first sets now so the first guns picked up don't pay for it
+	for (int32 setIndex = 0; setIndex < NumPrewarmedSets; ++setIndex)
+	{
+		FreeSets.Add(CreateSet());
+	}
+}
+
+FGrabComponentSet AGrabComponentPool::AcquireSet()
+{
+	FGrabComponentSet componentSet = FreeSets.Num() > 0 ? FreeSets.Pop(false) : CreateSet();
+	++NumSetsInUse;
+
+	// The handle only needs to tick while a gun can grab with it
+	componentSet.PhysicsHandle->SetComponentTickEnabled(true);
+	return componentSet;
+}
+
+void AGrabComponentPool::ReleaseSet(const FGrabComponentSet & componentSet)
+{
+	if (componentSet.IsValid() == false)
+	{
+		return;
+	}
+	--NumSetsInUse;
+
+	// Put everything back the way CreateSet left it, dropping references to the previous gun's meshes
+	componentSet.PhysicsHandle->ReleaseComponent();
+	componentSet.PhysicsHandle->SetComponentTickEnabled(false);
+	FGrabHandleSettings::FromHandle(GetDefault<UPhysicsHandleComponent>()).ApplyTo(componentSet.PhysicsHandle);
+	componentSet.SplineMesh->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	componentSet.SplineMesh->SetVisibility(false);
+	componentSet.SplineMesh->SetStaticMesh(nullptr);
+	componentSet.SplineMesh->EmptyOverrideMaterials();
+	componentSet.HoverSphere->SetVisibility(false);
+	componentSet.HoverSphere->SetStaticMesh(nullptr);
+	componentSet.HoverSphere->EmptyOverrideMaterials();
+
+	if (FreeSets.Num() < MaxFreeSets)
+	{
+		FreeSets.Add(componentSet);
+	}
+	else
+	{
+		DestroySet(componentSet);
+	}
+}
+
+FGrabComponentSet AGrabComponentPool::CreateSet()
+{
+	FGrabComponentSet componentSet;
+
+	componentSet.PhysicsHandle = NewObject<UPhysicsHandleComponent>(this);
+	componentSet.PhysicsHandle->RegisterComponent();
+	componentSet.PhysicsHandle->SetComponentTickEnabled(false);
+
+	// Neither mesh is attached to the pool, the beam is attached to the gun that acquires it and the sphere moves on its own
+	componentSet.SplineMesh = NewObject<USplineMeshComponent>(this);
+	componentSet.SplineMesh->SetMobility(EComponentMobility::Movable);
+	componentSet.SplineMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	componentSet.SplineMesh->SetVisibility(false);
+	componentSet.SplineMesh->RegisterComponent();
+
+	componentSet.HoverSphere = NewObject<UStaticMeshComponent>(this);
+	componentSet.HoverSphere->SetMobility(EComponentMobility::Movable);
+	componentSet.HoverSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	componentSet.HoverSphere->SetVisibility(false);
+	componentSet.HoverSphere->RegisterComponent();
+
+	return componentSet;
+}
+
+void AGrabComponentPool::DestroySet(const FGrabComponentSet & componentSet)
+{
+	componentSet.PhysicsHandle->DestroyComponent();
+	componentSet.SplineMesh->DestroyComponent();
+	componentSet.HoverSphere->DestroyComponent();
+}
+
+SIZE_T AGrabComponentPool::GetObjectFootprint(UObject * object)
+{
+	FArchiveCountMem countMem(object);
+	return countMem.GetMax() + object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+}
+
+void AGrabComponentPool::LogMemoryReport()
+{
+	// Footprint of the guns as they are now, pooled components are owned by the pool and so not counted here
+	int32 numGuns = 0;
+	int32 numGunsHoldingSets = 0;
+	SIZE_T totalGunBytes = 0;
+	for (TActorIterator<AGravityGun> gunIt(GetWorld()); gunIt; ++gunIt)
+	{
+		++numGuns;
+		numGunsHoldingSets += gunIt->HasGrabComponents() ? 1 : 0;
+
+		totalGunBytes += GetObjectFootprint(*gunIt);
+		TInlineComponentArray<UActorComponent *> gunComponents(*gunIt);
+		for (UActorComponent * gunComponent : gunComponents)
+		{
+			totalGunBytes += GetObjectFootprint(gunComponent);
+		}
+	}
+
+	if (numGuns == 0)
+	{
+		UE_LOG(LogGrabComponentPool, Log, TEXT("No gravity guns in the world"));
+		return;
+	}
+
+	// Measure a free set, making one if they are all handed out
+	if (FreeSets.Num() == 0)
+	{
+		FreeSets.Add(CreateSet());
+	}
+	const FGrabComponentSet & sampleSet = FreeSets[0];
+	const SIZE_T setBytes = GetObjectFootprint(sampleSet.PhysicsHandle) + GetObjectFootprint(sampleSet.SplineMesh) + GetObjectFootprint(sampleSet.HoverSphere);
+	const int32 numSets = NumSetsInUse + FreeSets.Num();
+
+	// Without pooling every gun would own a set of its own for its whole lifetime
+	const SIZE_T gunBytes = totalGunBytes / numGuns;
+	const SIZE_T unpooledTotalBytes = totalGunBytes + numGuns * setBytes;
+	const SIZE_T pooledTotalBytes = totalGunBytes + numSets * setBytes;
+
+	UE_LOG(LogGrabComponentPool, Log, TEXT("Gravity guns: %d (%d holding grab components), pooled sets: %d (%d free)"), numGuns, numGunsHoldingSets, numSets, FreeSets.Num());
+	UE_LOG(LogGrabComponentPool, Log, TEXT("Grab component set: %llu bytes, gun without set: %llu bytes"), (uint64)setBytes, (uint64)gunBytes);
+	UE_LOG(LogGrabComponentPool, Log, TEXT("Per weapon before pooling: %llu bytes, after pooling: %llu bytes"), (uint64)(unpooledTotalBytes / numGuns), (uint64)(pooledTotalBytes / numGuns));
+	UE_LOG(LogGrabComponentPool, Log, TEXT("Total before pooling: %llu bytes, after pooling: %llu bytes"), (uint64)unpooledTotalBytes, (uint64)pooledTotalBytes);
+}
+
+static FAutoConsoleCommandWithWorld GGrabComponentPoolMemoryReportCommand(
+	TEXT("GravityGun.MemoryReport"),
+	TEXT("Logs the per weapon memory footprint of gravity guns with and without grab component pooling"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld * world)
+	{
+		if (world && world->IsGameWorld())
+		{
+			if (AGrabComponentPool * pool = AGrabComponentPool::Get(world))
+			{
+				pool->LogMemoryReport();
+			}
+		}
+	}));
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "GrabComponentPool.generated.h"
+
+class UPhysicsHandleComponent;
+class USplineMeshComponent;
+class UStaticMeshComponent;
+class AGravityGun;
+
+/* Tuning for a pooled physics handle, kept on the gun and applied to whichever handle it acquires. Defaults match UPhysicsHandleComponent */
+USTRUCT(BlueprintType)
+struct FGrabHandleSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Handle")
+	bool bSoftAngularConstraint = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Handle")
+	bool bSoftLinearConstraint = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Handle")
+	bool bInterpolateTarget = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Handle")
+	float LinearDamping = 200.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Handle")
+	float LinearStiffness = 750.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Handle")
+	float AngularDamping = 500.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Handle")
+	float AngularStiffness = 1500.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Handle")
+	float InterpolationSpeed = 50.0f;
+
+	// Settings as they currently are on a handle
+	static FGrabHandleSettings FromHandle(const UPhysicsHandleComponent * physicsHandle);
+
+	// Only takes effect on the next grab, so apply before grabbing anything
+	void ApplyTo(UPhysicsHandleComponent * physicsHandle) const;
+};
+
+/* The components a gravity gun only needs while it is held, handed out together by the pool */
+USTRUCT()
+struct FGrabComponentSet
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UPhysicsHandleComponent * PhysicsHandle = nullptr;
+
+	// Beam connecting the gun to the grabbed object
+	UPROPERTY()
+	USplineMeshComponent * SplineMesh = nullptr;
+
+	// Forcefield sphere around the grabbed object
+	UPROPERTY()
+	UStaticMeshComponent * HoverSphere = nullptr;
+
+	bool IsValid() const { return PhysicsHandle && SplineMesh && HoverSphere; }
+};
+
+/**
+ *  Shared pool of the grab-only components of gravity guns
+ *  Guns acquire a set when they are picked up and return it when dropped, so guns lying in the level own none of them
+ *  The pooled components are owned by the pool actor, guns only attach and configure them while holding a set
+ */
+UCLASS(NotBlueprintable)
+class GRAVITYGUNPROJECT_API AGrabComponentPool : public AInfo
+{
+	GENERATED_BODY()
+
+private:
+	// Sets not currently handed out
+	UPROPERTY(Transient)
+	TArray<FGrabComponentSet> FreeSets;
+
+	int32 NumSetsInUse = 0;
+
+protected:
+	// Number of sets created up front when the pool is spawned
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grab Component Pool", meta = (ClampMin = "0"))
+	int32 NumPrewarmedSets = 1;
+
+	// Returned sets beyond this many free ones are destroyed instead of kept
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grab Component Pool", meta = (ClampMin = "0"))
+	int32 MaxFreeSets = 8;
+
+public:
+	// Returns the grab component pool for this world, spawning one if needed
+	static AGrabComponentPool * Get(UWorld * world);
+
+	// Hands out a set of components, creating one if the pool is empty
+	FGrabComponentSet AcquireSet();
+
+	// Takes a set back, the components are reset, detached and hidden
+	void ReleaseSet(const FGrabComponentSet & componentSet);
+
+	// Logs the memory footprint of the gravity guns in the world with and without pooling
+	void LogMemoryReport();
+
+protected:
+	// Begin AActor interface -------
+	virtual void BeginPlay() override;
+	// End AActor interface -------
+
+	FGrabComponentSet CreateSet();
+
+	void DestroySet(const FGrabComponentSet & componentSet);
+
+	// Size of the object itself plus any resources it exclusively owns
+	static SIZE_T GetObjectFootprint(UObject * object);
+};
@@ -0,0 +1,168 @@
+#include "GrabTargetHighlightComponent.h"
+#include "GravityGun.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+
+UGrabTargetHighlightComponent::UGrabTargetHighlightComponent()
+{
+	// Only ticks while the gun is held
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	QueryCompletedDelegate.BindUObject(this, &UGrabTargetHighlightComponent::OnQueryCompleted);
+}
+
+void UGrabTargetHighlightComponent::SetHighlightingEnabled(bool bEnabled)
+{
+	bHighlightingEnabled = bEnabled;
+	SetComponentTickEnabled(bEnabled);
+
+	if (bEnabled == false)
+	{
+		SetHighlightedComponent(nullptr);
+		CachedTarget.Reset();
+		TimeOfLastQuery = -1.0f;
+		// Any result still on its way no longer matches and is dropped when it arrives, even if highlighting is back on by then
+		PendingQuery = FTraceHandle();
+	}
+}
+
+bool UGrabTargetHighlightComponent::ConfirmCachedTarget(const FVector & traceStart, const FVector & traceEnd, FHitResult & outHitResult) const
+{
+	UPrimitiveComponent * target = CachedTarget.Get();
+	if (bHighlightingEnabled == false || target == nullptr || GetWorld()->GetTimeSeconds() - TimeOfLastQuery > MaxTargetAge)
+	{
+		return false;
+	}
+
+	// Tracing a single component is far cheaper than querying the scene
+	if (target->LineTraceComponent(outHitResult, traceStart, traceEnd, FCollisionQueryParams(FName(TEXT("GrabTargetConfirm")), false)) == false)
+	{
+		return false;
+	}
+
+	// Something grabbable may have moved in front of the target since it was found, and the grab has to take the nearest
+	// object like the full trace would. An any hit test up to the target is enough to tell and stops at the first blocker
+	TArray<TEnumAsByte<EObjectTypeQuery>> acceptedObjectTypes;
+	AGravityGun::GetGrabbableObjectTypes(acceptedObjectTypes);
+
+	FCollisionQueryParams occlusionParams(FName(TEXT("GrabTargetOcclusion")), false, GetOwner());
+	occlusionParams.AddIgnoredComponent(target);
+	if (AActor * owner = GetOwner())
+	{
+		occlusionParams.AddIgnoredActor(owner->GetAttachParentActor());
+	}
+
+	return GetWorld()->LineTraceTestByObjectType(traceStart, outHitResult.ImpactPoint, FCollisionObjectQueryParams(acceptedObjectTypes), occlusionParams) == false;
+}
+
+void UGrabTargetHighlightComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction * ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Only the player actually looking through the crosshair needs the highlight, checked here as the holder may not be
+	// possessed yet when the gun is picked up
+	AGravityGun * gun = Cast<AGravityGun>(GetOwner());
+	APawn * holder = gun ? Cast<APawn>(gun->GetAttachParentActor()) : nullptr;
+	USceneComponent * traceComponent = gun ? gun->GetTraceComponent() : nullptr;
+	if (holder == nullptr || holder->IsLocallyControlled() == false || traceComponent == nullptr)
+	{
+		return;
+	}
+
+	// Nothing to highlight while something is already held
+	if (gun->IsGrabbing())
+	{
+		SetHighlightedComponent(nullptr);
+		CachedTarget.Reset();
+		TimeOfLastQuery = -1.0f;
+		return;
+	}
+
+	// Wait for the previous query and never query more often than the interval allows
+	const float currentTime = GetWorld()->GetTimeSeconds();
+	const float timeSinceLastQuery = currentTime - TimeOfLastQuery;
+	if (PendingQuery.IsValid() || (TimeOfLastQuery >= 0.0f && timeSinceLastQuery < QueryInterval))
+	{
+		return;
+	}
+
+	// Keep the previous target while the aim has barely moved and the result is still fresh
+	const FVector queryOrigin = traceComponent->GetComponentLocation();
+	const FVector queryDirection = traceComponent->GetForwardVector();
+	const bool bAimChanged = TimeOfLastQuery < 0.0f
+		|| FVector::DotProduct(queryDirection, LastQueryDirection) < FMath::Cos(FMath::DegreesToRadians(AimAngleThreshold))
+		|| FVector::DistSquared(queryOrigin, LastQueryOrigin) > FMath::Square(AimMoveThreshold);
+	if (bAimChanged == false && timeSinceLastQuery < MaxTargetAge)
+	{
+		return;
+	}
+
+	TArray<TEnumAsByte<EObjectTypeQuery>> acceptedObjectTypes;
+	AGravityGun::GetGrabbableObjectTypes(acceptedObjectTypes);
+
+	FCollisionQueryParams queryParams(FName(TEXT("GrabTargetHighlight")), false, gun);
+	queryParams.AddIgnoredActor(gun->GetAttachParentActor());
+
+	// Same query as the grab trace, run asynchronously so its result is picked up next frame
+	PendingQuery = GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Single, queryOrigin, queryOrigin + queryDirection * gun->WeaponRange,
+		FCollisionObjectQueryParams(acceptedObjectTypes), queryParams, &QueryCompletedDelegate);
+
+	LastQueryOrigin = queryOrigin;
+	LastQueryDirection = queryDirection;
+	TimeOfLastQuery = currentTime;
+}
+
+void UGrabTargetHighlightComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Don't leave an object highlighted after the gun is gone
+	SetHighlightingEnabled(false);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGrabTargetHighlightComponent::OnQueryCompleted(const FTraceHandle & traceHandle, FTraceDatum & traceData)
+{
+	// Issued before the gun was dropped, or superseded by a newer query
+	if (bHighlightingEnabled == false || traceHandle != PendingQuery)
+	{
+		return;
+	}
+	PendingQuery = FTraceHandle();
+
+	UPrimitiveComponent * target = nullptr;
+	for (const FHitResult & hit : traceData.OutHits)
+	{
+		if (hit.bBlockingHit)
+		{
+			target = hit.Component.Get();
+			break;
+		}
+	}
+
+	CachedTarget = target;
+	SetHighlightedComponent(target);
+}
+
+void UGrabTargetHighlightComponent::SetHighlightedComponent(UPrimitiveComponent * newHighlightedComponent)
+{
+	UPrimitiveComponent * oldHighlightedComponent = HighlightedComponent.Get();
+	if (oldHighlightedComponent == newHighlightedComponent)
+	{
+		return;
+	}
+
+	// Drawing into custom depth is what the outline post process looks for
+	if (oldHighlightedComponent)
+	{
+		oldHighlightedComponent->SetRenderCustomDepth(false);
+	}
+	if (newHighlightedComponent)
+	{
+		newHighlightedComponent->SetCustomDepthStencilValue(HighlightStencilValue);
+		newHighlightedComponent->SetRenderCustomDepth(true);
+	}
+	HighlightedComponent = newHighlightedComponent;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WorldCollision.h"
+#include "GrabTargetHighlightComponent.generated.h"
+
+class UPrimitiveComponent;
+
+/**
+ *  Highlights the object the gravity gun would grab before the player clicks
+ *  The grab query runs asynchronously at a low rate and is only re-issued when the aim has moved past a threshold or the
+ *  last result has gone stale, so most frames cost one comparison. The cached target is shared with the primary and
+ *  secondary actions, which only have to confirm it against a single component instead of tracing the whole scene
+ */
+UCLASS(ClassGroup = (Weapon), meta = (BlueprintSpawnableComponent))
+class GRAVITYGUNPROJECT_API UGrabTargetHighlightComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+private:
+	// Object the last query found, null if it found nothing
+	TWeakObjectPtr<UPrimitiveComponent> CachedTarget;
+
+	// Object currently drawn with the highlight
+	TWeakObjectPtr<UPrimitiveComponent> HighlightedComponent;
+
+	/* Aim the last query was issued with */
+	FVector LastQueryOrigin = FVector::ZeroVector;
+
+	FVector LastQueryDirection = FVector::ZeroVector;
+
+	float TimeOfLastQuery = -1.0f;
+
+	// Handle of the query still on its way, invalid when none is. Results with any other handle are stale and dropped
+	FTraceHandle PendingQuery;
+
+	bool bHighlightingEnabled = false;
+
+	FTraceDelegate QueryCompletedDelegate;
+
+protected:
+	// Minimum time between two queries
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grab Target Highlight")
+	float QueryInterval = 0.1f;
+
+	// The cached target is kept while the aim turns less than this many degrees
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grab Target Highlight")
+	float AimAngleThreshold = 1.0f;
+
+	// The cached target is kept while the aim moves less than this many cm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grab Target Highlight")
+	float AimMoveThreshold = 10.0f;
+
+	// A query is re-issued after this long even if the aim has not changed, as the target itself may have moved
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grab Target Highlight")
+	float MaxTargetAge = 0.5f;
+
+	// Stencil value written by the highlighted object, for the post process outline material to pick up
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grab Target Highlight")
+	int32 HighlightStencilValue = 1;
+
+public:
+	UGrabTargetHighlightComponent();
+
+	// Switched on while the gun is held, only a locally controlled holder actually gets highlights
+	void SetHighlightingEnabled(bool bEnabled);
+
+	// Confirms the cached target against a single trace so actions can skip the full scene query. Returns false if there is
+	// no fresh target, the trace no longer hits it or another grabbable object is now in front of it
+	bool ConfirmCachedTarget(const FVector & traceStart, const FVector & traceEnd, FHitResult & outHitResult) const;
+
+	// Begin UActorComponent interface -------
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction * ThisTickFunction) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End UActorComponent interface -------
+
+protected:
+	// Called by the world once the async query has finished
+	void OnQueryCompleted(const FTraceHandle & traceHandle, FTraceDatum & traceData);
+
+	// Moves the highlight over to a new object, null clears it
+	void SetHighlightedComponent(UPrimitiveComponent * newHighlightedComponent);
+};
@@ -8,22 +8,96 @@
 #include "Components/SplineMeshComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "DrawDebugHelpers.h"
+#include "GameFramework/Pawn.h"
+#include "EngineUtils.h"
+#include "LaunchedObjectTrackerComponent.h"
+#include "LaunchedObjectRegistry.h"
+#include "GrabTargetHighlightComponent.h"
+#include "PropRewindBuffer.h"
+#include "PropSettleManager.h"
+#include "HeldObjectSweepManager.h"
+#include "GrabComponentPool.h"
 
 AGravityGun::AGravityGun()
 {
-	// Spawn physics handle component
-	PhysicsHandleComponent = CreateDefaultSubobject<UPhysicsHandleComponent>(TEXT("PhysicsHandleComponent"));
+	// Physics handle, spline mesh and hover sphere are only needed while the gun is held, so they come from the grab component pool on pickup
 
-	// Spawn spline mesh component
-	SplineMeshComponent = CreateDefaultSubobject<USplineMeshComponent>(TEXT("SplineMeshComponent"));
-	SplineMeshComponent->SetupAttachment(RootComponent);
-	// Switch off visibility until the gun is active
-	SplineMeshComponent->SetVisibility(false);
+	// Spawn launched object tracker
+	LaunchedObjectTracker = CreateDefaultSubobject<ULaunchedObjectTrackerComponent>(TEXT("LaunchedObjectTracker"));
+
+	// Spawn grab target highlight
+	GrabTargetHighlight = CreateDefaultSubobject<UGrabTargetHighlightComponent>(TEXT("GrabTargetHighlight"));
 
-	// Gravity Gun requires tick
+	// Gravity Gun requires tick, but only while it is held
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 }
 
+void AGravityGun::GetGrabbableObjectTypes(TArray<TEnumAsByte<EObjectTypeQuery>> & outObjectTypes)
+{
+	// EObjectTypeQuery == ECollisionChannel 
+	outObjectTypes.Add(EObjectTypeQuery::ObjectTypeQuery2); // World Dynamic
+	outObjectTypes.Add(EObjectTypeQuery::ObjectTypeQuery4); // Physics Body
+}
+
+bool AGravityGun::IsGrabbableComponent(const UPrimitiveComponent * component)
+{
+	// Mirrors what the grab trace can hit, a movable WorldDynamic or PhysicsBody that responds to queries
+	if (component == nullptr || component->Mobility != EComponentMobility::Movable || component->GetOwner() == nullptr)
+	{
+		return false;
+	}
+
+	const ECollisionChannel objectType = component->GetCollisionObjectType();
+	const ECollisionEnabled::Type collisionEnabled = component->GetCollisionEnabled();
+	return (objectType == ECC_WorldDynamic || objectType == ECC_PhysicsBody)
+		&& (collisionEnabled == ECollisionEnabled::QueryOnly || collisionEnabled == ECollisionEnabled::QueryAndPhysics);
+}
+
+void AGravityGun::GatherGrabbableComponents(UWorld * world, TArray<UPrimitiveComponent *> & outComponents)
+{
+	for (TActorIterator<AActor> actorIt(world); actorIt; ++actorIt)
+	{
+		// Skip anything attached to another actor, like a carried weapon
+		if (actorIt->GetAttachParentActor() != nullptr)
+		{
+			continue;
+		}
+
+		TInlineComponentArray<UPrimitiveComponent *> primitiveComponents(*actorIt);
+		for (UPrimitiveComponent * component : primitiveComponents)
+		{
+			if (IsGrabbableComponent(component))
+			{
+				outComponents.Add(component);
+			}
+		}
+	}
+}
+
+UPrimitiveComponent * AGravityGun::GetGrabbedComponent() const
+{
+	return bIsGrabbing ? PhysicsHandleComponent->GetGrabbedComponent() : nullptr;
+}
+
+void AGravityGun::RestoreGrab(UPrimitiveComponent * targetComponent, const FVector & newHandleLocation, bool bRestoreStaticOnRelease)
+{
+	// Drop whatever is held now, the restored state replaces it entirely
+	if (bIsGrabbing)
+	{
+		this->ReleaseGrabbedObject();
+	}
+
+	if (targetComponent && HasGrabComponents())
+	{
+		this->GrabComponent(targetComponent, newHandleLocation);
+		// The restored object is always simulating by now, so what it was before the original grab has to come from the caller
+		bTargetWasSimulating = bRestoreStaticOnRelease == false;
+		// Start the handle where the object was held instead of lerping in from wherever it was last
+		PhysicsHandleComponent->SetTargetLocation(newHandleLocation + HandleLocationOffset);
+	}
+}
 
 void AGravityGun::TraceForObjectToGrab()
 {
@@ -40,9 +114,7 @@ void AGravityGun::TraceForObjectToGrab()
 		if (thisWorld)
 		{
 			TArray<TEnumAsByte<EObjectTypeQuery>> acceptedObjectTypes;
-			// EObjectTypeQuery == ECollisionChannel 
-			acceptedObjectTypes.Add(EObjectTypeQuery::ObjectTypeQuery2); // World Dynamic
-			acceptedObjectTypes.Add(EObjectTypeQuery::ObjectTypeQuery4); // Physics Body
+			GetGrabbableObjectTypes(acceptedObjectTypes);
 
 			TArray<AActor *> actorsToIgnore;
 			FHitResult outHitResult;
@@ -50,35 +122,93 @@ void AGravityGun::TraceForObjectToGrab()
 			// Check flag to see if we should draw debug of the traces
 			EDrawDebugTrace::Type drawDebugType = bShouldDebugTraces ? EDrawDebugTrace::Persistent : EDrawDebugTrace::None;
 			
-			// Do the actual trace
-			bBlockingHit = UKismetSystemLibrary::LineTraceSingleForObjects((UObject *)thisWorld, traceStartLocation, traceEndLocation, acceptedObjectTypes, false, actorsToIgnore, drawDebugType, outHitResult, true);
+			// Actions issued by a remote client are traced against where the props were when the client saw them
+			// The buffer is normally spawned when the first remote player joins, see AGravityGunCharacter::PossessedBy()
+			APropRewindBuffer * rewindBuffer = (ActionTimestamp >= 0.0f && HasAuthority() && GetNetMode() != NM_Standalone) ? APropRewindBuffer::Get(thisWorld) : nullptr;
+			if (rewindBuffer)
+			{
+				bBlockingHit = rewindBuffer->RewindLineTrace(traceStartLocation, traceEndLocation, ActionTimestamp, outHitResult);
+
+				// Drawn the same way the kismet trace draws, red up to the hit and green beyond it
+				if (bShouldDebugTraces)
+				{
+					const FVector debugHitLocation = bBlockingHit ? outHitResult.ImpactPoint : traceEndLocation;
+					DrawDebugLine(thisWorld, traceStartLocation, debugHitLocation, FColor::Red, true);
+					if (bBlockingHit)
+					{
+						DrawDebugLine(thisWorld, debugHitLocation, traceEndLocation, FColor::Green, true);
+						DrawDebugPoint(thisWorld, debugHitLocation, 16.0f, FColor::Red, true);
+					}
+				}
+			}
+			// Reuse the highlighted target if it is still under the crosshair, unless traces are being debugged and have to be drawn
+			else if (bShouldDebugTraces == false && GrabTargetHighlight->ConfirmCachedTarget(traceStartLocation, traceEndLocation, outHitResult))
+			{
+				bBlockingHit = true;
+			}
+			else
+			{
+				// Do the actual trace
+				bBlockingHit = UKismetSystemLibrary::LineTraceSingleForObjects((UObject *)thisWorld, traceStartLocation, traceEndLocation, acceptedObjectTypes, false, actorsToIgnore, drawDebugType, outHitResult, true);
+			}
 
 			// If trace encountered an object
 			if (bBlockingHit)
 			{
-				// If the object was WorldDynamic and not simulating physics, set it to do so
-				outHitResult.Component->SetSimulatePhysics(true);
-				// Grab the object
-				PhysicsHandleComponent->GrabComponentAtLocation(outHitResult.Component.Get(), NAME_None, outHitResult.Actor->GetActorLocation() + HandleGrabOffset);
-				bIsGrabbing = true;
-				HandleLocation = outHitResult.Location;
-				CurrentTargetObject = outHitResult.Actor.Get();
+				this->GrabComponent(outHitResult.Component.Get(), outHitResult.Location);
 			}
 		}
 	}
 }
 
+void AGravityGun::GrabComponent(UPrimitiveComponent * targetComponent, const FVector & grabLocation)
+{
+	// Can't grab anything without a physics handle, i.e. while the gun is not held
+	if (PhysicsHandleComponent == nullptr)
+	{
+		return;
+	}
+
+	// Remember whether the object only simulates because we grabbed it, including when it was grabbed before and has not settled yet
+	APropSettleManager * settleManager = APropSettleManager::Get(this->GetWorld());
+	const bool bWasSettlingToStatic = settleManager ? settleManager->UnregisterProp(targetComponent) : false;
+	bTargetWasSimulating = targetComponent->IsSimulatingPhysics() && bWasSettlingToStatic == false;
+	// If the object was WorldDynamic and not simulating physics, set it to do so
+	targetComponent->SetSimulatePhysics(true);
+	// Stop tracking it as a projectile in case it was launched earlier and is still flying, by whichever gun launched it so
+	// another gun never credits impacts or restores hit notifications while this one holds it
+	ALaunchedObjectRegistry::UnregisterLaunchedObject(this->GetWorld(), targetComponent);
+	// Grab the object
+	PhysicsHandleComponent->GrabComponentAtLocation(targetComponent, NAME_None, targetComponent->GetOwner()->GetActorLocation() + HandleGrabOffset);
+	bIsGrabbing = true;
+	HandleLocation = grabLocation;
+	CurrentTargetObject = targetComponent->GetOwner();
+}
+
 void AGravityGun::ReleaseGrabbedObject()
 {
 	// Call cleanup for sound effects/particles etc spawned for hover/grab effect
 	this->EndGrabCleanup();
 
 	bIsGrabbing = false;
+	UPrimitiveComponent * releasedComponent = PhysicsHandleComponent ? PhysicsHandleComponent->GetGrabbedComponent() : nullptr;
 	// Actually releases the grabbed object 
-	PhysicsHandleComponent->ReleaseComponent();
+	if (PhysicsHandleComponent)
+	{
+		PhysicsHandleComponent->ReleaseComponent();
+	}
+	// Hand the object over to be put back into a cheap resting state once it stops moving
+	APropSettleManager * settleManager = releasedComponent ? APropSettleManager::Get(this->GetWorld()) : nullptr;
+	if (settleManager)
+	{
+		settleManager->RegisterReleasedProp(releasedComponent, bTargetWasSimulating == false);
+	}
 	CurrentTargetObject = nullptr;
 	// Switch off hover meshes visibility when gun is inactive
-	SplineMeshComponent->SetVisibility(false);
+	if (SplineMeshComponent)
+	{
+		SplineMeshComponent->SetVisibility(false);
+	}
 	if (HoverSphereComponent)
 	{
 		HoverSphereComponent->SetVisibility(false);
@@ -88,24 +218,77 @@ void AGravityGun::ReleaseGrabbedObject()
 void AGravityGun::BeginPlay()
 {
 	Super::BeginPlay();
+}
+
+void AGravityGun::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Hand the grab components back if the gun goes away while held
+	this->ReturnGrabComponents();
+
+	Super::EndPlay(EndPlayReason);
+}
 
-	// If hover mesh is specified, spawn it
-	if (HoverMesh)
+void AGravityGun::AcquireGrabComponents()
+{
+	// Only game worlds have a pool, guns picked up in the editor just go without
+	UWorld * thisWorld = this->GetWorld();
+	AGrabComponentPool * pool = (thisWorld && thisWorld->IsGameWorld()) ? AGrabComponentPool::Get(thisWorld) : nullptr;
+	if (pool == nullptr || HasGrabComponents())
 	{
-		UStaticMeshComponent * sphereComponent = NewObject<UStaticMeshComponent>(this, UStaticMeshComponent::StaticClass(), TEXT("HoverSphereComponent"));
-		sphereComponent->RegisterComponent();
-		sphereComponent->SetStaticMesh(HoverMesh);
-		sphereComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		HoverSphereComponent = sphereComponent;
-		HoverSphereComponent->SetWorldScale3D(FVector(3.0f));
-		// Switch off visibility of hover meshes until gun is active
-		HoverSphereComponent->SetVisibility(false);
-		if (HoverMeshMaterial)
-		{
-			HoverSphereComponent->SetMaterial(0, HoverMeshMaterial);
-		}
-		// Do not attach as we want it to move independently
+		return;
+	}
+
+	FGrabComponentSet grabComponents = pool->AcquireSet();
+	PhysicsHandleComponent = grabComponents.PhysicsHandle;
+	PhysicsHandleSettings.ApplyTo(PhysicsHandleComponent);
+
+	// Attach the connecting forcefield mesh to the gun and switch off its visibility until the gun is active
+	SplineMeshComponent = grabComponents.SplineMesh;
+	SplineMeshComponent->AttachToComponent(RootComponent, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+	SplineMeshComponent->SetStaticMesh(BeamMesh);
+	if (BeamMeshMaterial)
+	{
+		SplineMeshComponent->SetMaterial(0, BeamMeshMaterial);
+	}
+	SplineMeshComponent->SetVisibility(false);
+
+	// Set up the hover sphere, it is not attached as we want it to move independently
+	HoverSphereComponent = grabComponents.HoverSphere;
+	HoverSphereComponent->SetStaticMesh(HoverMesh);
+	HoverSphereComponent->SetWorldScale3D(FVector(3.0f));
+	if (HoverMeshMaterial)
+	{
+		HoverSphereComponent->SetMaterial(0, HoverMeshMaterial);
+	}
+	HoverSphereComponent->SetVisibility(false);
+}
+
+void AGravityGun::ReturnGrabComponents()
+{
+	if (HasGrabComponents() == false)
+	{
+		return;
+	}
+
+	if (bIsGrabbing)
+	{
+		this->ReleaseGrabbedObject();
+	}
+
+	FGrabComponentSet grabComponents;
+	grabComponents.PhysicsHandle = PhysicsHandleComponent;
+	grabComponents.SplineMesh = SplineMeshComponent;
+	grabComponents.HoverSphere = HoverSphereComponent;
+
+	// While the world is being torn down the pool goes away along with its components
+	if (AGrabComponentPool * pool = AGrabComponentPool::Get(this->GetWorld()))
+	{
+		pool->ReleaseSet(grabComponents);
 	}
+
+	PhysicsHandleComponent = nullptr;
+	SplineMeshComponent = nullptr;
+	HoverSphereComponent = nullptr;
 }
 
 void AGravityGun::EndGrabCleanup()
@@ -124,7 +307,25 @@ void AGravityGun::Tick(float DeltaSeconds)
 		AActor * attachParent = this->GetAttachParentActor();
 		if (attachParent)
 		{
-			HandleLocation = attachParent->GetActorLocation() + this->TraceComponent->GetForwardVector() * GrabbedItemDistance;
+			const FVector holdOrigin = attachParent->GetActorLocation();
+			const FVector holdDirection = this->TraceComponent->GetForwardVector();
+			float holdDistance = GrabbedItemDistance;
+
+			// Pull the object in if last frame's sweep found it would end up inside level geometry, then queue this frame's sweep
+			AHeldObjectSweepManager * sweepManager = AHeldObjectSweepManager::Get(this->GetWorld());
+			UPrimitiveComponent * grabbedComponent = PhysicsHandleComponent->GetGrabbedComponent();
+			if (sweepManager && grabbedComponent)
+			{
+				float safeDistance;
+				if (sweepManager->GetSafeHeldDistance(this, safeDistance))
+				{
+					holdDistance = FMath::Min(holdDistance, safeDistance);
+				}
+				// Swept along the same path the handle target follows, which is shifted by the handle offset
+				sweepManager->RequestSweep(this, grabbedComponent, holdOrigin + HandleLocationOffset, holdDirection, GrabbedItemDistance);
+			}
+
+			HandleLocation = holdOrigin + holdDirection * holdDistance;
 
 			// Get old location
 			FVector oldLocation;
@@ -147,10 +348,23 @@ void AGravityGun::Tick(float DeltaSeconds)
 	}
 }
 
+void AGravityGun::OnWeaponPickedUp()
+{
+	// Grab components and tick are only needed while the gun is held
+	this->AcquireGrabComponents();
+	SetActorTickEnabled(true);
+	// Start highlighting what the new holder is aiming at
+	GrabTargetHighlight->SetHighlightingEnabled(true);
+}
+
 void AGravityGun::OnWeaponDropped()
 {
 	// Drop any currently grabbed objects
 	this->ReleaseGrabbedObject();
+	GrabTargetHighlight->SetHighlightingEnabled(false);
+	// Grab components and tick are only needed while the gun is held
+	this->ReturnGrabComponents();
+	SetActorTickEnabled(false);
 }
 
 void AGravityGun::PrimaryWeaponAction()
@@ -162,7 +376,12 @@ void AGravityGun::PrimaryWeaponAction()
 		// Apply impulse to push it forwards
 		UPrimitiveComponent * targetMesh = nullptr;
 		targetMesh = Cast<UPrimitiveComponent>(CurrentTargetObject->GetComponentByClass(UPrimitiveComponent::StaticClass()));
-		targetMesh->AddImpulse(TraceComponent->GetForwardVector() * PushForceMagnitude, NAME_None, true);
+		const FVector launchVelocityChange = TraceComponent->GetForwardVector() * PushForceMagnitude;
+		targetMesh->AddImpulse(launchVelocityChange, NAME_None, true);
+		// Track it so its impacts can be reacted to, damage is credited to whoever is holding the gun
+		// The impulse is only simulated on the next physics step so the launch velocity is passed in rather than read back
+		APawn * holder = Cast<APawn>(this->GetAttachParentActor());
+		LaunchedObjectTracker->RegisterLaunchedObject(targetMesh, targetMesh->GetPhysicsLinearVelocity() + launchVelocityChange, holder ? holder->GetController() : nullptr);
 
 		// Release the object
 		this->ReleaseGrabbedObject();
@@ -178,7 +397,12 @@ void AGravityGun::PrimaryWeaponAction()
 			// Apply force
 			UPrimitiveComponent * targetMesh = nullptr;
 			targetMesh = Cast<UPrimitiveComponent>(CurrentTargetObject->GetComponentByClass(UPrimitiveComponent::StaticClass()));
-			targetMesh->AddImpulse(TraceComponent->GetForwardVector() * PushForceMagnitude, NAME_None, true);
+			const FVector launchVelocityChange = TraceComponent->GetForwardVector() * PushForceMagnitude;
+			targetMesh->AddImpulse(launchVelocityChange, NAME_None, true);
+			// Track it so its impacts can be reacted to, damage is credited to whoever is holding the gun
+			// The impulse is only simulated on the next physics step so the launch velocity is passed in rather than read back
+			APawn * holder = Cast<APawn>(this->GetAttachParentActor());
+			LaunchedObjectTracker->RegisterLaunchedObject(targetMesh, targetMesh->GetPhysicsLinearVelocity() + launchVelocityChange, holder ? holder->GetController() : nullptr);
 
 			// Release the object
 			this->ReleaseGrabbedObject();
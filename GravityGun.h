@@ -2,10 +2,13 @@
 
 #include "CoreMinimal.h"
 #include "BaseWeapon.h"
+#include "GrabComponentPool.h"
 #include "GravityGun.generated.h"
 
 class UPhysicsHandleComponent;
 class USplineMeshComponent;
+class ULaunchedObjectTrackerComponent;
+class UGrabTargetHighlightComponent;
 class USoundBase;
 class UMaterial;
 
@@ -25,9 +28,12 @@ private:
 	// Pointer to currently grabbed object
 	AActor * CurrentTargetObject = nullptr;
 
-	// Sphere mesh that moves with target object 
+	// Sphere mesh that moves with target object, acquired from the grab component pool while the gun is held
 	UStaticMeshComponent * HoverSphereComponent = nullptr;
 
+	// Whether the currently grabbed object was simulating physics before it was grabbed
+	bool bTargetWasSimulating = false;
+
 protected:
 	// Is the gravity gun currently grabbing something?
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
@@ -57,12 +63,32 @@ protected:
 	UMaterialInterface * HoverMeshMaterial;
 
 	// Used for the forcefield mesh that connects the gravity gun to the grabbed object
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
-	USplineMeshComponent * SplineMeshComponent;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
+	UStaticMesh * BeamMesh;
+
+	// Material for the connecting forcefield mesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
+	UMaterialInterface * BeamMeshMaterial;
+
+	// Used for the forcefield mesh that connects the gravity gun to the grabbed object, acquired from the grab component pool while the gun is held
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Gravity Gun")
+	USplineMeshComponent * SplineMeshComponent = nullptr;
+
+	// Used for the actual physics interaction behavior with the target object, acquired from the grab component pool while the gun is held
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Gravity Gun")
+	UPhysicsHandleComponent * PhysicsHandleComponent = nullptr;
 
-	// Used for the actual physics interaction behavior with the target object
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
-	UPhysicsHandleComponent * PhysicsHandleComponent;
+	// Stiffness, damping and interpolation of the physics handle, applied to the pooled handle whenever the gun acquires one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
+	FGrabHandleSettings PhysicsHandleSettings;
+
+	// Follows objects after they are launched and turns their hits into impact events
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Gravity Gun")
+	ULaunchedObjectTrackerComponent * LaunchedObjectTracker;
+
+	// Highlights what would be grabbed before the player clicks, and lets actions reuse that result
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Gravity Gun")
+	UGrabTargetHighlightComponent * GrabTargetHighlight;
 
 	// How much to offset the target object from the handle location
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gravity Gun")
@@ -84,9 +110,37 @@ public:
 	AGravityGun();
 
 	// Begin AWeaponBase interface -------
+	virtual void OnWeaponPickedUp() override;
+
 	virtual void OnWeaponDropped() override;
 	// End AWeaponBase interface -------
 
+	// Object types that the grab trace looks for
+	static void GetGrabbableObjectTypes(TArray<TEnumAsByte<EObjectTypeQuery>> & outObjectTypes);
+
+	// Whether a component is something the gravity gun is able to grab
+	static bool IsGrabbableComponent(const UPrimitiveComponent * component);
+
+	// Collects every grabbable component in the world that is not attached to another actor
+	static void GatherGrabbableComponents(UWorld * world, TArray<UPrimitiveComponent *> & outComponents);
+
+	// Component currently held by the gun, null if not grabbing
+	UPrimitiveComponent * GetGrabbedComponent() const;
+
+	// Replaces the held state of the gun, used when restoring physics snapshots. Passing null just releases the held object
+	// bRestoreStaticOnRelease says whether the object only simulates because it was grabbed, see ShouldRestoreGrabbedStatic()
+	void RestoreGrab(UPrimitiveComponent * targetComponent, const FVector & newHandleLocation, bool bRestoreStaticOnRelease = false);
+
+	// Whether the held object was not simulating before it was grabbed and so goes back to not simulating once it settles after release
+	FORCEINLINE bool ShouldRestoreGrabbedStatic() const { return bIsGrabbing && bTargetWasSimulating == false; }
+
+	FORCEINLINE const FVector & GetHandleLocation() const { return HandleLocation; }
+
+	FORCEINLINE bool IsGrabbing() const { return bIsGrabbing; }
+
+	// Whether the gun currently holds a set of components from the grab component pool
+	FORCEINLINE bool HasGrabComponents() const { return PhysicsHandleComponent != nullptr; }
+
 protected:
 	// Called when a grab is ending to perform cleanup of spawned sounds, particles etc
 	void EndGrabCleanup();
@@ -94,12 +148,23 @@ protected:
 	// Trace forward from TraceComponent to find an interactible object
 	void TraceForObjectToGrab();
 
+	// Starts holding the given component with the physics handle
+	void GrabComponent(UPrimitiveComponent * targetComponent, const FVector & grabLocation);
+
 	// Called when currently grabbed object is released
 	void ReleaseGrabbedObject();
 
+	// Takes the components only needed while held from the grab component pool and sets them up for this gun
+	void AcquireGrabComponents();
+
+	// Gives the grab components back to the pool
+	void ReturnGrabComponents();
+
 	// Begin AActor interface -------
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void Tick(float DeltaSeconds) override;
 	// End AActor interface -------
 	
@@ -8,6 +8,10 @@
 #include "Kismet/GameplayStatics.h"
 #include "MotionControllerComponent.h"
 #include "BaseWeapon.h"
+#include "WeaponActionQueueComponent.h"
+#include "PropRewindBuffer.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
 #include "Engine/World.h"
 #include "GameFramework/Actor.h"
 #include "SubclassOf.h"
@@ -44,6 +48,9 @@ AGravityGunCharacter::AGravityGunCharacter()
 	Mesh1P->RelativeRotation = FRotator(1.9f, -19.19f, 5.2f);
 	Mesh1P->RelativeLocation = FVector(-0.5f, -4.4f, -155.7f);
 
+	// Create the queue that weapon input goes through
+	WeaponActionQueue = CreateDefaultSubobject<UWeaponActionQueueComponent>(TEXT("WeaponActionQueue"));
+	WeaponActionQueue->OnWeaponActionPerformed.AddUObject(this, &AGravityGunCharacter::OnWeaponActionPerformed);
 }
 
 void AGravityGunCharacter::PickupWeapon(ABaseWeapon * newWeapon)
@@ -57,6 +64,7 @@ void AGravityGunCharacter::PickupWeapon(ABaseWeapon * newWeapon)
 	WeaponActor->SetTraceComponent(FirstPersonCameraComponent);
 	WeaponActor->WeaponMesh->SetSimulatePhysics(false);
 	WeaponActor->OnWeaponPickedUp();
+	WeaponActionQueue->SetWeapon(WeaponActor);
 }
 
 void AGravityGunCharacter::DropWeapon()
@@ -65,6 +73,7 @@ void AGravityGunCharacter::DropWeapon()
 	WeaponActor->DetachFromActor(FDetachmentTransformRules(EDetachmentRule::KeepWorld, true));
 	WeaponActor->WeaponMesh->SetSimulatePhysics(true);
 	WeaponActor = nullptr;
+	WeaponActionQueue->SetWeapon(nullptr);
 }
 
 #if WITH_EDITOR
@@ -115,6 +124,18 @@ void AGravityGunCharacter::BeginPlay()
 	Mesh1P->SetHiddenInGame(false, true);
 }
 
+void AGravityGunCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	// Start recording prop history as soon as a remote player joins, so their first actions already have history to rewind
+	APlayerController * playerController = Cast<APlayerController>(NewController);
+	if (playerController && playerController->IsLocalController() == false)
+	{
+		APropRewindBuffer::Get(this->GetWorld());
+	}
+}
+
 void AGravityGunCharacter::BeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult)
 {
 	if (OtherActor != WeaponActor)
@@ -183,37 +204,41 @@ void AGravityGunCharacter::OnInteract()
 
 void AGravityGunCharacter::OnWeaponPrimary()
 {
-	UWorld* const World = GetWorld();
-	if (World != nullptr)
-	{
-		if (WeaponActor)
-		{
-			WeaponActor->PrimaryWeaponAction();
-		}
-	}
-
-	// Try and play a firing animation if specified
-	if (FireAnimation != nullptr)
-	{
-		// Get the animation object for the arms mesh
-		UAnimInstance* AnimInstance = Mesh1P->GetAnimInstance();
-		if (AnimInstance != nullptr)
-		{
-			AnimInstance->Montage_Play(FireAnimation, 1.f);
-		}
-	}
+	this->QueueWeaponAction(EWeaponAction::Primary);
 }
 
 void AGravityGunCharacter::OnWeaponSecondary()
 {
-	UWorld* const World = GetWorld();
-	if (World != nullptr)
+	this->QueueWeaponAction(EWeaponAction::Secondary);
+}
+
+void AGravityGunCharacter::QueueWeaponAction(EWeaponAction Action)
+{
+	// Performed by the action queue on its next step
+	WeaponActionQueue->QueueAction(Action);
+
+	// The server performs the action too, stamped with the server time the client saw it at so its traces can be rewound
+	if (Role < ROLE_Authority)
 	{
-		if (WeaponActor)
-		{
-			WeaponActor->SecondaryWeaponAction();
-		}
+		AGameStateBase * gameState = this->GetWorld()->GetGameState();
+		ServerQueueWeaponAction(Action, gameState ? gameState->GetServerWorldTimeSeconds() : -1.0f);
 	}
+}
+
+void AGravityGunCharacter::ServerQueueWeaponAction_Implementation(EWeaponAction Action, float ServerActionTime)
+{
+	// A client can't have seen the future, and without a valid time the action is just performed as it is now
+	const float actionTimestamp = ServerActionTime >= 0.0f ? FMath::Min(ServerActionTime, this->GetWorld()->GetTimeSeconds()) : -1.0f;
+	WeaponActionQueue->QueueAction(Action, actionTimestamp);
+}
+
+bool AGravityGunCharacter::ServerQueueWeaponAction_Validate(EWeaponAction Action, float ServerActionTime)
+{
+	return FMath::IsFinite(ServerActionTime);
+}
+
+void AGravityGunCharacter::OnWeaponActionPerformed(EWeaponAction Action)
+{
 	// Try and play a firing animation if specified
 	if (FireAnimation != nullptr)
 	{
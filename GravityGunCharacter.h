@@ -2,10 +2,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "BaseWeapon.h"
 #include "GravityGunProject.generated.h"
 
 class UInputComponent;
 class ABaseWeapon;
+class UWeaponActionQueueComponent;
 
 /* Character class that ties together input, camera and collision for the player */
 UCLASS(config=Game)
@@ -22,6 +24,10 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FirstPersonCameraComponent;
 
+	/* Merges and paces weapon input before it reaches the weapon */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Weapon, meta = (AllowPrivateAccess = "true"))
+	class UWeaponActionQueueComponent* WeaponActionQueue;
+
 	/* Points to the actual instance of the weapon the player is currently carrying */
 	UPROPERTY(BlueprintReadOnly, meta = (AllowPrivateAccess = "true"), Category = Weapon)
 	ABaseWeapon * WeaponActor;
@@ -52,12 +58,24 @@ private:
 
 	void DropWeapon();
 
+	/* Called by the action queue once a weapon action has actually been performed */
+	void OnWeaponActionPerformed(EWeaponAction Action);
+
+	/* Queues an action locally and, on a client, sends it to the server as well */
+	void QueueWeaponAction(EWeaponAction Action);
+
+	/* Queues a remote client's action on the server, ServerActionTime is the server world time the client issued it at */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerQueueWeaponAction(EWeaponAction Action, float ServerActionTime);
+
 protected:
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 	virtual void BeginPlay() override;
 
+	virtual void PossessedBy(AController* NewController) override;
+
 	// Function called when collider begins overlaps with an object
 	UFUNCTION()
 	void BeginOverlap(UPrimitiveComponent* OverlappedComponent,
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+/**
+ *  Returns the manager actor of the given class for a world
+ *  A manager placed in the level is used so its settings can be edited, otherwise one is spawned with default settings
+ *  Lookups are cached per world so this is cheap enough to call every frame
+ */
+template<typename ManagerType>
+ManagerType * GetOrSpawnWorldManager(UWorld * world)
+{
+	if (world == nullptr || world->bIsTearingDown)
+	{
+		return nullptr;
+	}
+
+	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<ManagerType>> managersByWorld;
+
+	if (TWeakObjectPtr<ManagerType> * cachedManager = managersByWorld.Find(world))
+	{
+		if (cachedManager->IsValid())
+		{
+			return cachedManager->Get();
+		}
+	}
+
+	// Forget about worlds that have since been destroyed, e.g. previous PIE sessions
+	for (auto managerIt = managersByWorld.CreateIterator(); managerIt; ++managerIt)
+	{
+		if (managerIt.Key().IsValid() == false)
+		{
+			managerIt.RemoveCurrent();
+		}
+	}
+
+	ManagerType * manager = nullptr;
+	TActorIterator<ManagerType> managerActorIt(world);
+	if (managerActorIt)
+	{
+		manager = *managerActorIt;
+	}
+	else
+	{
+		FActorSpawnParameters spawnParameters;
+		spawnParameters.ObjectFlags |= RF_Transient;
+		manager = world->SpawnActor<ManagerType>(spawnParameters);
+	}
+
+	managersByWorld.Add(world, manager);
+	return manager;
+}
@@ -0,0 +1,124 @@
+#include "HeldObjectSweepManager.h"
+#include "GravityGun.h"
+#include "GravityGunWorldManager.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+
+AHeldObjectSweepManager::AHeldObjectSweepManager()
+{
+	// Ticks after the guns so every request made this frame goes out in the same batch
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	SweepCompletedDelegate.BindUObject(this, &AHeldObjectSweepManager::OnSweepCompleted);
+}
+
+AHeldObjectSweepManager * AHeldObjectSweepManager::Get(UWorld * world)
+{
+	return GetOrSpawnWorldManager<AHeldObjectSweepManager>(world);
+}
+
+void AHeldObjectSweepManager::RequestSweep(AGravityGun * gun, UPrimitiveComponent * heldComponent, const FVector & origin, const FVector & direction, float distance)
+{
+	FHeldObjectSweep * sweep = Sweeps.FindByPredicate([gun](const FHeldObjectSweep & entry) { return entry.Gun.Get() == gun; });
+	if (sweep == nullptr)
+	{
+		sweep = &Sweeps[Sweeps.AddDefaulted()];
+		sweep->Gun = gun;
+		sweep->GunId = gun->GetUniqueID();
+	}
+
+	// A different object than last frame means the previous result no longer applies
+	if (sweep->HeldComponent.Get() != heldComponent)
+	{
+		sweep->HeldComponent = heldComponent;
+		sweep->bHasResult = false;
+	}
+
+	sweep->Origin = origin;
+	sweep->Direction = direction;
+	sweep->Distance = distance;
+	sweep->bRequested = true;
+
+	SetActorTickEnabled(true);
+}
+
+bool AHeldObjectSweepManager::GetSafeHeldDistance(const AGravityGun * gun, float & outSafeDistance) const
+{
+	const FHeldObjectSweep * sweep = Sweeps.FindByPredicate([gun](const FHeldObjectSweep & entry) { return entry.Gun.Get() == gun; });
+	if (sweep == nullptr || sweep->bHasResult == false)
+	{
+		return false;
+	}
+
+	outSafeDistance = sweep->SafeDistance;
+	return true;
+}
+
+void AHeldObjectSweepManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	UWorld * world = GetWorld();
+	// Only level geometry is swept against, other props are free to be pushed around by the held object
+	const FCollisionObjectQueryParams objectQueryParams(ECC_WorldStatic);
+
+	for (int32 index = Sweeps.Num() - 1; index >= 0; --index)
+	{
+		FHeldObjectSweep & sweep = Sweeps[index];
+		AGravityGun * gun = sweep.Gun.Get();
+		UPrimitiveComponent * heldComponent = sweep.HeldComponent.Get();
+
+		// The gun let go or went away since last frame
+		if (sweep.bRequested == false || gun == nullptr || heldComponent == nullptr)
+		{
+			Sweeps.RemoveAtSwap(index);
+			continue;
+		}
+		sweep.bRequested = false;
+
+		FCollisionQueryParams queryParams(FName(TEXT("HeldObjectSweep")), false, gun);
+		queryParams.AddIgnoredActor(gun->GetAttachParentActor());
+		queryParams.AddIgnoredActor(heldComponent->GetOwner());
+
+		// The object is never held closer than the minimum anyway, so there is nothing to learn from sweeping that stretch
+		sweep.SweepStartDistance = FMath::Min(MinHeldDistance, sweep.Distance);
+		const FVector sweepStart = sweep.Origin + sweep.Direction * sweep.SweepStartDistance;
+
+		// Conservative box around the held object, the world batches all async traces issued this frame and runs them together
+		world->AsyncSweepByObjectType(EAsyncTraceType::Single, sweepStart, sweep.Origin + sweep.Direction * sweep.Distance, FQuat::Identity, objectQueryParams,
+			FCollisionShape::MakeBox(heldComponent->Bounds.BoxExtent), queryParams, &SweepCompletedDelegate, sweep.GunId);
+	}
+
+	// Nothing left to sweep, stop ticking until a gun grabs something again
+	if (Sweeps.Num() == 0)
+	{
+		SetActorTickEnabled(false);
+	}
+}
+
+void AHeldObjectSweepManager::OnSweepCompleted(const FTraceHandle & traceHandle, FTraceDatum & traceData)
+{
+	FHeldObjectSweep * sweep = Sweeps.FindByPredicate([&traceData](const FHeldObjectSweep & entry) { return entry.GunId == traceData.UserData; });
+	if (sweep == nullptr)
+	{
+		return;
+	}
+
+	const float fullDistance = sweep->SweepStartDistance + (traceData.End - traceData.Start).Size();
+	sweep->SafeDistance = fullDistance;
+
+	// Pull the object in to just short of whatever it would have hit
+	for (const FHitResult & hit : traceData.OutHits)
+	{
+		// Already overlapping at the start says nothing about which way is clear, leave it to the solver rather than
+		// pulling the object in towards the holder
+		if (hit.bBlockingHit && hit.bStartPenetrating == false)
+		{
+			sweep->SafeDistance = FMath::Clamp(sweep->SweepStartDistance + hit.Distance - SkinDistance, sweep->SweepStartDistance, fullDistance);
+			break;
+		}
+	}
+	sweep->bHasResult = true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "WorldCollision.h"
+#include "HeldObjectSweepManager.generated.h"
+
+class AGravityGun;
+class UPrimitiveComponent;
+
+/**
+ *  Keeps objects held by gravity guns out of level geometry
+ *  Every frame each holding gun asks for its held object to be swept from the holder out to the full hold distance,
+ *  all of these sweeps are issued together as one batch of async traces and their results are read back the next frame
+ *  Guns then pull the held object in to the safe distance instead of driving it into a wall for the solver to push back out
+ */
+UCLASS(NotBlueprintable)
+class GRAVITYGUNPROJECT_API AHeldObjectSweepManager : public AInfo
+{
+	GENERATED_BODY()
+
+private:
+	struct FHeldObjectSweep
+	{
+		TWeakObjectPtr<AGravityGun> Gun;
+		// Passed as the async trace user data to match results back up with their gun
+		uint32 GunId = 0;
+		TWeakObjectPtr<UPrimitiveComponent> HeldComponent;
+		FVector Origin = FVector::ZeroVector;
+		FVector Direction = FVector::ForwardVector;
+		float Distance = 0.0f;
+		// How far along Direction the last issued sweep started
+		float SweepStartDistance = 0.0f;
+		// Furthest distance along Direction the held object fits at, from the most recent completed sweep
+		float SafeDistance = 0.0f;
+		bool bHasResult = false;
+		// Set when the gun asks for a sweep this frame, guns that stop asking are dropped
+		bool bRequested = false;
+	};
+
+	TArray<FHeldObjectSweep> Sweeps;
+
+	FTraceDelegate SweepCompletedDelegate;
+
+protected:
+	// Gap kept between the held object and whatever the sweep hit
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Held Object Sweeps")
+	float SkinDistance = 4.0f;
+
+	// Held objects are never pulled in closer than this to the holder, sweeps start this far out so they don't begin inside
+	// the holder or a wall they are standing against
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Held Object Sweeps")
+	float MinHeldDistance = 100.0f;
+
+public:
+	AHeldObjectSweepManager();
+
+	// Returns the sweep manager for this world, spawning one if needed
+	static AHeldObjectSweepManager * Get(UWorld * world);
+
+	// Queue a sweep of the held component from origin along direction for this frame's batch
+	void RequestSweep(AGravityGun * gun, UPrimitiveComponent * heldComponent, const FVector & origin, const FVector & direction, float distance);
+
+	// Distance the gun's held object can safely be held at, from the last completed sweep. Returns false if no result is available yet
+	bool GetSafeHeldDistance(const AGravityGun * gun, float & outSafeDistance) const;
+
+	// Begin AActor interface -------
+	virtual void Tick(float DeltaSeconds) override;
+	// End AActor interface -------
+
+protected:
+	// Called by the world once a batched sweep has finished
+	void OnSweepCompleted(const FTraceHandle & traceHandle, FTraceDatum & traceData);
+};
@@ -0,0 +1,40 @@
+#include "LaunchedObjectRegistry.h"
+#include "LaunchedObjectTrackerComponent.h"
+#include "GravityGunWorldManager.h"
+#include "Components/PrimitiveComponent.h"
+
+ALaunchedObjectRegistry * ALaunchedObjectRegistry::Get(UWorld * world)
+{
+	return GetOrSpawnWorldManager<ALaunchedObjectRegistry>(world);
+}
+
+ULaunchedObjectTrackerComponent * ALaunchedObjectRegistry::FindTracker(const UPrimitiveComponent * launchedComponent) const
+{
+	const TWeakObjectPtr<ULaunchedObjectTrackerComponent> * tracker = TrackersByObject.Find(launchedComponent);
+	return tracker ? tracker->Get() : nullptr;
+}
+
+void ALaunchedObjectRegistry::SetTracker(UPrimitiveComponent * launchedComponent, ULaunchedObjectTrackerComponent * tracker)
+{
+	TrackersByObject.Add(launchedComponent, tracker);
+}
+
+void ALaunchedObjectRegistry::ClearTracker(const TWeakObjectPtr<UPrimitiveComponent> & launchedComponent, const ULaunchedObjectTrackerComponent * tracker)
+{
+	// Another tracker may have taken the body over in the meantime
+	const TWeakObjectPtr<ULaunchedObjectTrackerComponent> * currentTracker = TrackersByObject.Find(launchedComponent);
+	if (currentTracker && currentTracker->Get() == tracker)
+	{
+		TrackersByObject.Remove(launchedComponent);
+	}
+}
+
+void ALaunchedObjectRegistry::UnregisterLaunchedObject(UWorld * world, UPrimitiveComponent * launchedComponent)
+{
+	ALaunchedObjectRegistry * registry = Get(world);
+	ULaunchedObjectTrackerComponent * tracker = registry ? registry->FindTracker(launchedComponent) : nullptr;
+	if (tracker)
+	{
+		tracker->UnregisterLaunchedObject(launchedComponent);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "LaunchedObjectRegistry.generated.h"
+
+class UPrimitiveComponent;
+class ULaunchedObjectTrackerComponent;
+
+/**
+ *  Records which launched object tracker is following each launched body, so a body can be handed over or dropped
+ *  without asking every tracker in the world. A body is only ever tracked by the tracker of the gun that launched it last
+ */
+UCLASS(NotBlueprintable)
+class GRAVITYGUNPROJECT_API ALaunchedObjectRegistry : public AInfo
+{
+	GENERATED_BODY()
+
+private:
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, TWeakObjectPtr<ULaunchedObjectTrackerComponent>> TrackersByObject;
+
+public:
+	// Returns the launched object registry for this world, spawning one if needed
+	static ALaunchedObjectRegistry * Get(UWorld * world);
+
+	// Tracker currently following the body, null if it is not being tracked
+	ULaunchedObjectTrackerComponent * FindTracker(const UPrimitiveComponent * launchedComponent) const;
+
+	// Records that the tracker has started following the body
+	void SetTracker(UPrimitiveComponent * launchedComponent, ULaunchedObjectTrackerComponent * tracker);
+
+	// Forgets the body if the tracker is still the one following it, takes the weak pointer so destroyed bodies can be removed too
+	void ClearTracker(const TWeakObjectPtr<UPrimitiveComponent> & launchedComponent, const ULaunchedObjectTrackerComponent * tracker);
+
+	// Stops whichever tracker is following the body, e.g. because it was grabbed again
+	static void UnregisterLaunchedObject(UWorld * world, UPrimitiveComponent * launchedComponent);
+};
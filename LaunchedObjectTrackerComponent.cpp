@@ -0,0 +1,293 @@
+#include "LaunchedObjectTrackerComponent.h"
+#include "LaunchedObjectRegistry.h"
+#include "Components/PrimitiveComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+#include "Engine/World.h"
+
+ULaunchedObjectTrackerComponent::ULaunchedObjectTrackerComponent()
+{
+	// Only ticks while something is being tracked, and after physics so hits from this frame are already collected
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void ULaunchedObjectTrackerComponent::RegisterLaunchedObject(UPrimitiveComponent * launchedComponent, const FVector & launchVelocity, AController * instigatorController)
+{
+	// Only simulating bodies can fly off and hit anything
+	if (launchedComponent == nullptr || launchedComponent->IsSimulatingPhysics() == false)
+	{
+		return;
+	}
+
+	int32 slotIndex = FindSlot(launchedComponent);
+	// Relaunching an already tracked object just restarts its timers
+	if (slotIndex == INDEX_NONE)
+	{
+		// Take the body over from any other tracker still following it, so only one ever binds its hits
+		ALaunchedObjectRegistry * registry = ALaunchedObjectRegistry::Get(GetWorld());
+		ULaunchedObjectTrackerComponent * previousTracker = registry ? registry->FindTracker(launchedComponent) : nullptr;
+		if (previousTracker && previousTracker != this)
+		{
+			previousTracker->UnregisterLaunchedObject(launchedComponent);
+		}
+
+		slotIndex = AllocateSlot();
+
+		FTrackedObjectSlot & newSlot = Slots[slotIndex];
+		newSlot.Component = launchedComponent;
+		newSlot.bRestoreNotifyRigidBodyCollision = launchedComponent->BodyInstance.bNotifyRigidBodyCollision;
+
+		// Simulating bodies only report hits if asked to
+		launchedComponent->SetNotifyRigidBodyCollision(true);
+		launchedComponent->OnComponentHit.AddUniqueDynamic(this, &ULaunchedObjectTrackerComponent::OnTrackedObjectHit);
+
+		if (registry)
+		{
+			registry->SetTracker(launchedComponent, this);
+		}
+	}
+
+	FTrackedObjectSlot & slot = Slots[slotIndex];
+	slot.InstigatorController = instigatorController;
+	// Hits in the first step after the launch are checked against this, reading the body's velocity now would still give the
+	// velocity it had while held
+	slot.LastVelocity = launchVelocity;
+	slot.TimeLaunched = GetWorld()->GetTimeSeconds();
+	slot.TimeOfLastImpact = -1.0f;
+	slot.bImpactPendingThisFrame = false;
+
+	SetComponentTickEnabled(true);
+}
+
+void ULaunchedObjectTrackerComponent::UnregisterLaunchedObject(UPrimitiveComponent * launchedComponent)
+{
+	int32 slotIndex = FindSlot(launchedComponent);
+	if (slotIndex != INDEX_NONE)
+	{
+		ReleaseSlot(slotIndex);
+	}
+}
+
+void ULaunchedObjectTrackerComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction * ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Dispatch this frame's batch of impacts up to the per frame budget, take ownership of the batch first as listeners may unregister objects
+	TArray<FPendingImpact> impacts = MoveTemp(PendingImpacts);
+	int32 numDispatched = 0;
+	for (const FPendingImpact & impact : impacts)
+	{
+		if (numDispatched >= MaxImpactEventsPerFrame)
+		{
+			break;
+		}
+
+		const FTrackedObjectSlot & slot = Slots[impact.SlotIndex];
+		if (slot.bInUse && slot.Component.IsValid())
+		{
+			DispatchImpact(slot, impact);
+			++numDispatched;
+		}
+	}
+	// Hand the allocation back so the next batch does not reallocate
+	impacts.Reset();
+	PendingImpacts = MoveTemp(impacts);
+
+	// Drop anything that has come to rest or has been flying for too long
+	const float currentTime = GetWorld()->GetTimeSeconds();
+	for (int32 slotIndex = 0; slotIndex < Slots.Num(); ++slotIndex)
+	{
+		FTrackedObjectSlot & slot = Slots[slotIndex];
+		if (slot.bInUse == false)
+		{
+			continue;
+		}
+
+		slot.bImpactPendingThisFrame = false;
+
+		UPrimitiveComponent * component = slot.Component.Get();
+		const float timeTracked = currentTime - slot.TimeLaunched;
+		if (component == nullptr || component->IsSimulatingPhysics() == false || timeTracked > MaxTrackTime)
+		{
+			ReleaseSlot(slotIndex);
+			continue;
+		}
+
+		slot.LastVelocity = component->GetPhysicsLinearVelocity();
+		if (timeTracked > MinTrackTime && slot.LastVelocity.SizeSquared() < FMath::Square(SettledSpeed))
+		{
+			ReleaseSlot(slotIndex);
+		}
+	}
+
+	// Nothing left to watch, stop ticking until the next launch
+	if (NumTrackedObjects == 0)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void ULaunchedObjectTrackerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Unbind from every tracked body so none of them keep calling into a dead component
+	for (int32 slotIndex = 0; slotIndex < Slots.Num(); ++slotIndex)
+	{
+		if (Slots[slotIndex].bInUse)
+		{
+			ReleaseSlot(slotIndex);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ULaunchedObjectTrackerComponent::OnTrackedObjectHit(UPrimitiveComponent * HitComponent, AActor * OtherActor, UPrimitiveComponent * OtherComp, FVector NormalImpulse, const FHitResult & Hit)
+{
+	int32 slotIndex = FindSlot(HitComponent);
+	if (slotIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Only the first hit of each object per frame makes it into the batch
+	FTrackedObjectSlot & slot = Slots[slotIndex];
+	if (slot.bImpactPendingThisFrame)
+	{
+		return;
+	}
+
+	const float currentTime = GetWorld()->GetTimeSeconds();
+	if (slot.TimeOfLastImpact >= 0.0f && currentTime - slot.TimeOfLastImpact < MinTimeBetweenImpacts)
+	{
+		return;
+	}
+
+	// Only the velocity into the surface counts, so grazing hits and sliding contacts are ignored
+	const float impactSpeed = FMath::Abs(FVector::DotProduct(slot.LastVelocity, Hit.ImpactNormal));
+	if (impactSpeed < MinImpactSpeed)
+	{
+		return;
+	}
+
+	slot.bImpactPendingThisFrame = true;
+	slot.TimeOfLastImpact = currentTime;
+
+	FPendingImpact impact;
+	impact.SlotIndex = slotIndex;
+	impact.HitActor = OtherActor;
+	impact.Hit = Hit;
+	impact.ImpactSpeed = impactSpeed;
+	PendingImpacts.Add(impact);
+}
+
+void ULaunchedObjectTrackerComponent::DispatchImpact(const FTrackedObjectSlot & slot, const FPendingImpact & impact)
+{
+	AActor * launchedActor = slot.Component->GetOwner();
+	AActor * hitActor = impact.HitActor.Get();
+	const FVector impactLocation = impact.Hit.ImpactPoint;
+
+	// Try and play the sound if specified
+	if (ImpactSound != nullptr)
+	{
+		UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, impactLocation);
+	}
+
+	// Try to spawn the particle if specified
+	if (ImpactParticleSystem)
+	{
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticleSystem, impactLocation, impact.Hit.ImpactNormal.Rotation(), true);
+	}
+
+	// Decals project along their X axis, so point it into the hit surface
+	if (ImpactDecalMaterial)
+	{
+		UGameplayStatics::SpawnDecalAtLocation(this, ImpactDecalMaterial, ImpactDecalSize, impactLocation, (-impact.Hit.ImpactNormal).Rotation(), ImpactDecalLifeSpan);
+	}
+
+	if (ImpactDamagePerSpeed > 0.0f && hitActor)
+	{
+		UGameplayStatics::ApplyPointDamage(hitActor, impact.ImpactSpeed * ImpactDamagePerSpeed, slot.LastVelocity.GetSafeNormal(), impact.Hit, slot.InstigatorController.Get(), launchedActor, ImpactDamageType);
+	}
+
+	OnLaunchedObjectImpact.Broadcast(launchedActor, hitActor, impact.Hit, impact.ImpactSpeed);
+}
+
+int32 ULaunchedObjectTrackerComponent::FindSlot(const UPrimitiveComponent * component) const
+{
+	// The table is small enough that a linear scan beats maintaining a lookup map
+	for (int32 slotIndex = 0; slotIndex < Slots.Num(); ++slotIndex)
+	{
+		if (Slots[slotIndex].bInUse && Slots[slotIndex].Component.Get() == component)
+		{
+			return slotIndex;
+		}
+	}
+	return INDEX_NONE;
+}
+
+int32 ULaunchedObjectTrackerComponent::AllocateSlot()
+{
+	// The table is created on first launch so weapons that never fire don't pay for it
+	if (Slots.Num() == 0)
+	{
+		Slots.SetNum(MaxTrackedObjects);
+		for (int32 slotIndex = 0; slotIndex < Slots.Num(); ++slotIndex)
+		{
+			Slots[slotIndex].NextFreeSlot = (slotIndex + 1 < Slots.Num()) ? slotIndex + 1 : INDEX_NONE;
+		}
+		FirstFreeSlot = 0;
+		// At most one impact per slot is queued each frame
+		PendingImpacts.Reserve(MaxTrackedObjects);
+	}
+
+	// Table is full, make room by dropping the object that was launched the longest time ago
+	if (FirstFreeSlot == INDEX_NONE)
+	{
+		int32 oldestSlot = 0;
+		for (int32 slotIndex = 1; slotIndex < Slots.Num(); ++slotIndex)
+		{
+			if (Slots[slotIndex].TimeLaunched < Slots[oldestSlot].TimeLaunched)
+			{
+				oldestSlot = slotIndex;
+			}
+		}
+		ReleaseSlot(oldestSlot);
+	}
+
+	int32 slotIndex = FirstFreeSlot;
+	FTrackedObjectSlot & slot = Slots[slotIndex];
+	FirstFreeSlot = slot.NextFreeSlot;
+	slot.NextFreeSlot = INDEX_NONE;
+	slot.bInUse = true;
+	++NumTrackedObjects;
+	return slotIndex;
+}
+
+void ULaunchedObjectTrackerComponent::ReleaseSlot(int32 slotIndex)
+{
+	FTrackedObjectSlot & slot = Slots[slotIndex];
+
+	// Put the body back the way we found it
+	if (UPrimitiveComponent * component = slot.Component.Get())
+	{
+		component->OnComponentHit.RemoveDynamic(this, &ULaunchedObjectTrackerComponent::OnTrackedObjectHit);
+		component->SetNotifyRigidBodyCollision(slot.bRestoreNotifyRigidBodyCollision);
+	}
+
+	// Done with the body, unless another tracker has taken it over since
+	if (ALaunchedObjectRegistry * registry = ALaunchedObjectRegistry::Get(GetWorld()))
+	{
+		registry->ClearTracker(slot.Component, this);
+	}
+
+	// Any queued impact now refers to a stale slot
+	PendingImpacts.RemoveAll([slotIndex](const FPendingImpact & impact) { return impact.SlotIndex == slotIndex; });
+
+	slot = FTrackedObjectSlot();
+	slot.NextFreeSlot = FirstFreeSlot;
+	FirstFreeSlot = slotIndex;
+	--NumTrackedObjects;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "LaunchedObjectTrackerComponent.generated.h"
+
+class UPrimitiveComponent;
+class USoundBase;
+class UParticleSystem;
+class UMaterialInterface;
+class UDamageType;
+class AController;
+
+// Broadcast when a launched object hits something hard enough to count as an impact
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FLaunchedObjectImpactDelegate, AActor *, LaunchedActor, AActor *, HitActor, const FHitResult &, Hit, float, ImpactSpeed);
+
+/**
+ *  Tracks objects launched by a weapon so gameplay can react to their impacts without binding hit delegates on every prop
+ *  Bodies live in a fixed-capacity table of slots that is reused between launches, hits are batched and dispatched once per frame
+ *  Which tracker follows each body is recorded in the world's ALaunchedObjectRegistry
+ */
+UCLASS(ClassGroup = (Weapon), meta = (BlueprintSpawnableComponent))
+class GRAVITYGUNPROJECT_API ULaunchedObjectTrackerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+private:
+	// One entry of the tracking table, free slots are chained together through NextFreeSlot
+	struct FTrackedObjectSlot
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		TWeakObjectPtr<AController> InstigatorController;
+		// Velocity sampled on the last tick, hit callbacks fire after the solver so this is the closest to the pre-impact velocity
+		FVector LastVelocity = FVector::ZeroVector;
+		float TimeLaunched = 0.0f;
+		float TimeOfLastImpact = -1.0f;
+		int32 NextFreeSlot = INDEX_NONE;
+		bool bInUse = false;
+		bool bImpactPendingThisFrame = false;
+		// Whether the component generated hit events before we switched them on
+		bool bRestoreNotifyRigidBodyCollision = false;
+	};
+
+	// Hit notification collected from the physics callback and dispatched on the next tick
+	struct FPendingImpact
+	{
+		int32 SlotIndex;
+		TWeakObjectPtr<AActor> HitActor;
+		FHitResult Hit;
+		float ImpactSpeed;
+	};
+
+	TArray<FTrackedObjectSlot> Slots;
+
+	TArray<FPendingImpact> PendingImpacts;
+
+	int32 FirstFreeSlot = INDEX_NONE;
+
+	int32 NumTrackedObjects = 0;
+
+protected:
+	// Maximum number of launched objects tracked at once, the oldest one is dropped when a new one is launched while full
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Launched Objects", meta = (ClampMin = "1"))
+	int32 MaxTrackedObjects = 32;
+
+	// Maximum number of impact events dispatched in a single frame, any extra impacts that frame are discarded
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects", meta = (ClampMin = "1"))
+	int32 MaxImpactEventsPerFrame = 8;
+
+	// Impacts slower than this (cm/s along the hit normal) are ignored
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	float MinImpactSpeed = 300.0f;
+
+	// Minimum time between two impact events from the same object, stops resting contacts from spamming events
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	float MinTimeBetweenImpacts = 0.2f;
+
+	// Objects slower than this (cm/s) are no longer tracked
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	float SettledSpeed = 50.0f;
+
+	// Grace period after launch before an object can be considered settled
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	float MinTrackTime = 0.25f;
+
+	// Objects are no longer tracked after this many seconds regardless of their speed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	float MaxTrackTime = 5.0f;
+
+	/* These are triggered at the impact location for every dispatched impact */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	USoundBase * ImpactSound;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	UParticleSystem * ImpactParticleSystem;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	UMaterialInterface * ImpactDecalMaterial;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	FVector ImpactDecalSize = FVector(16.0f, 32.0f, 32.0f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	float ImpactDecalLifeSpan = 10.0f;
+
+	// Damage applied to the hit actor per cm/s of impact speed, no damage is applied if zero
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	float ImpactDamagePerSpeed = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Launched Objects")
+	TSubclassOf<UDamageType> ImpactDamageType;
+
+public:
+	UPROPERTY(BlueprintAssignable, Category = "Launched Objects")
+	FLaunchedObjectImpactDelegate OnLaunchedObjectImpact;
+
+public:
+	ULaunchedObjectTrackerComponent();
+
+	// Start tracking a body that was just launched, instigator is credited with any impact damage
+	// Launch velocity is the velocity the body will have once the launch impulse has been simulated
+	void RegisterLaunchedObject(UPrimitiveComponent * launchedComponent, const FVector & launchVelocity, AController * instigatorController);
+
+	// Stop tracking a body, e.g. because it was grabbed again
+	void UnregisterLaunchedObject(UPrimitiveComponent * launchedComponent);
+
+	FORCEINLINE int32 GetNumTrackedObjects() const { return NumTrackedObjects; }
+
+	// Begin UActorComponent interface -------
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction * ThisTickFunction) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End UActorComponent interface -------
+
+protected:
+	// Bound to OnComponentHit of every tracked body
+	UFUNCTION()
+	void OnTrackedObjectHit(UPrimitiveComponent * HitComponent, AActor * OtherActor, UPrimitiveComponent * OtherComp, FVector NormalImpulse, const FHitResult & Hit);
+
+	// Spawn effects and apply damage for a single impact
+	void DispatchImpact(const FTrackedObjectSlot & slot, const FPendingImpact & impact);
+
+private:
+	int32 FindSlot(const UPrimitiveComponent * component) const;
+
+	int32 AllocateSlot();
+
+	void ReleaseSlot(int32 slotIndex);
+};
@@ -0,0 +1,332 @@
+#include "PhysicsSnapshotLibrary.h"
+#include "GravityGun.h"
+#include "PropSettleManager.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPhysicsSnapshot, Log, All);
+
+namespace PhysicsSnapshot
+{
+	// 'GGSS', bump Version whenever a record layout changes
+	const uint32 Magic = 0x47475353;
+	const uint32 Version = 2;
+
+	enum EPropFlags : uint32
+	{
+		PropFlag_Simulating = 1 << 0,
+		PropFlag_Awake = 1 << 1,
+		// Watched by the settle manager after being released
+		PropFlag_Settling = 1 << 2,
+		// Switched back to not simulating once it settles, only set along with PropFlag_Settling
+		PropFlag_RestoreStatic = 1 << 3,
+	};
+
+	enum EGunFlags : uint32
+	{
+		// The held object goes back to not simulating once it settles after release
+		GunFlag_RestoreGrabbedStatic = 1 << 0,
+	};
+
+	// File layout is a header followed by NumProps prop records and then NumGuns gun records
+	// Records only hold 4 byte fields so they can be read in place from a mapped file without any padding or alignment concerns
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 NumProps;
+		uint32 NumGuns;
+	};
+
+	struct FPropRecord
+	{
+		// Objects are matched up by a hash of their path name when restoring
+		uint32 PathHash;
+		uint32 Flags;
+		float Location[3];
+		float Rotation[4];
+		float LinearVelocity[3];
+		float AngularVelocity[3];
+	};
+
+	struct FGunRecord
+	{
+		uint32 PathHash;
+		// Zero when the gun was not holding anything
+		uint32 GrabbedPathHash;
+		uint32 Flags;
+		float HandleLocation[3];
+	};
+
+	static_assert(sizeof(FHeader) == 16, "Snapshot header layout changed, bump the version");
+	static_assert(sizeof(FPropRecord) == 60, "Snapshot prop record layout changed, bump the version");
+	static_assert(sizeof(FGunRecord) == 24, "Snapshot gun record layout changed, bump the version");
+
+	uint32 HashObjectPath(const UObject * object)
+	{
+		return FCrc::StrCrc32(*object->GetPathName());
+	}
+
+	void PackVector(const FVector & vector, float outValues[3])
+	{
+		outValues[0] = vector.X;
+		outValues[1] = vector.Y;
+		outValues[2] = vector.Z;
+	}
+
+	FVector UnpackVector(const float values[3])
+	{
+		return FVector(values[0], values[1], values[2]);
+	}
+
+	FString ResolveSnapshotPath(const FString & filePath)
+	{
+		return FPaths::IsRelative(filePath) ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Snapshots"), filePath) : filePath;
+	}
+}
+
+bool UPhysicsSnapshotLibrary::CapturePhysicsSnapshot(UObject * WorldContextObject, const FString & FilePath)
+{
+	using namespace PhysicsSnapshot;
+
+	UWorld * world = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	if (world == nullptr)
+	{
+		return false;
+	}
+
+	const double startTime = FPlatformTime::Seconds();
+
+	TArray<UPrimitiveComponent *> props;
+	AGravityGun::GatherGrabbableComponents(world, props);
+
+	TArray<AGravityGun *> guns;
+	for (TActorIterator<AGravityGun> gunIt(world); gunIt; ++gunIt)
+	{
+		guns.Add(*gunIt);
+	}
+
+	APropSettleManager * settleManager = APropSettleManager::Get(world);
+
+	// Records are written straight into one buffer sized up front
+	TArray<uint8> buffer;
+	buffer.SetNumUninitialized(sizeof(FHeader) + props.Num() * sizeof(FPropRecord) + guns.Num() * sizeof(FGunRecord));
+
+	FHeader * header = reinterpret_cast<FHeader *>(buffer.GetData());
+	header->Magic = Magic;
+	header->Version = Version;
+	header->NumProps = props.Num();
+	header->NumGuns = guns.Num();
+
+	FPropRecord * propRecords = reinterpret_cast<FPropRecord *>(header + 1);
+	for (int32 propIndex = 0; propIndex < props.Num(); ++propIndex)
+	{
+		UPrimitiveComponent * prop = props[propIndex];
+		FPropRecord & record = propRecords[propIndex];
+
+		const bool bSimulating = prop->IsSimulatingPhysics();
+		record.PathHash = HashObjectPath(prop);
+		record.Flags = (bSimulating ? PropFlag_Simulating : 0) | (bSimulating && prop->RigidBodyIsAwake() ? PropFlag_Awake : 0);
+
+		// Props still settling after a release are recorded so a restored run settles them the same way
+		bool bRestoreStaticOnSettle = false;
+		if (settleManager && settleManager->IsWatchingProp(prop, bRestoreStaticOnSettle))
+		{
+			record.Flags |= PropFlag_Settling | (bRestoreStaticOnSettle ? PropFlag_RestoreStatic : 0);
+		}
+
+		const FQuat rotation = prop->GetComponentQuat();
+		PackVector(prop->GetComponentLocation(), record.Location);
+		record.Rotation[0] = rotation.X;
+		record.Rotation[1] = rotation.Y;
+		record.Rotation[2] = rotation.Z;
+		record.Rotation[3] = rotation.W;
+		PackVector(bSimulating ? prop->GetPhysicsLinearVelocity() : FVector::ZeroVector, record.LinearVelocity);
+		PackVector(bSimulating ? prop->GetPhysicsAngularVelocityInDegrees() : FVector::ZeroVector, record.AngularVelocity);
+	}
+
+	FGunRecord * gunRecords = reinterpret_cast<FGunRecord *>(propRecords + props.Num());
+	for (int32 gunIndex = 0; gunIndex < guns.Num(); ++gunIndex)
+	{
+		AGravityGun * gun = guns[gunIndex];
+		FGunRecord & record = gunRecords[gunIndex];
+
+		UPrimitiveComponent * grabbedComponent = gun->GetGrabbedComponent();
+		record.PathHash = HashObjectPath(gun);
+		record.GrabbedPathHash = grabbedComponent ? HashObjectPath(grabbedComponent) : 0;
+		record.Flags = gun->ShouldRestoreGrabbedStatic() ? GunFlag_RestoreGrabbedStatic : 0;
+		PackVector(gun->GetHandleLocation(), record.HandleLocation);
+	}
+
+	const FString fullPath = ResolveSnapshotPath(FilePath);
+	if (FFileHelper::SaveArrayToFile(buffer, *fullPath) == false)
+	{
+		UE_LOG(LogPhysicsSnapshot, Warning, TEXT("Failed to write physics snapshot to %s"), *fullPath);
+		return false;
+	}
+
+	UE_LOG(LogPhysicsSnapshot, Log, TEXT("Captured %d props and %d gravity guns to %s in %.2f ms"), props.Num(), guns.Num(), *fullPath, (FPlatformTime::Seconds() - startTime) * 1000.0);
+	return true;
+}
+
+bool UPhysicsSnapshotLibrary::RestorePhysicsSnapshot(UObject * WorldContextObject, const FString & FilePath)
+{
+	using namespace PhysicsSnapshot;
+
+	UWorld * world = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	if (world == nullptr)
+	{
+		return false;
+	}
+
+	const double startTime = FPlatformTime::Seconds();
+	const FString fullPath = ResolveSnapshotPath(FilePath);
+
+	// Map the file so records are read in place, falling back to a plain read on platforms without mapped file support
+	// The region is declared after the handle so it is unmapped before the handle is closed
+	TUniquePtr<IMappedFileHandle> mappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*fullPath));
+	TUniquePtr<IMappedFileRegion> mappedRegion(mappedFile ? mappedFile->MapRegion() : nullptr);
+	TArray<uint8> fileData;
+
+	const uint8 * data = nullptr;
+	int64 dataSize = 0;
+	if (mappedRegion)
+	{
+		data = mappedRegion->GetMappedPtr();
+		dataSize = mappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(fileData, *fullPath))
+	{
+		data = fileData.GetData();
+		dataSize = fileData.Num();
+	}
+
+	if (data == nullptr || dataSize < (int64)sizeof(FHeader))
+	{
+		UE_LOG(LogPhysicsSnapshot, Warning, TEXT("Failed to read physics snapshot from %s"), *fullPath);
+		return false;
+	}
+
+	const FHeader * header = reinterpret_cast<const FHeader *>(data);
+	const int64 expectedSize = sizeof(FHeader) + (int64)header->NumProps * sizeof(FPropRecord) + (int64)header->NumGuns * sizeof(FGunRecord);
+	if (header->Magic != Magic || header->Version != Version || dataSize < expectedSize)
+	{
+		UE_LOG(LogPhysicsSnapshot, Warning, TEXT("%s is not a valid version %u physics snapshot"), *fullPath, Version);
+		return false;
+	}
+
+	// Look up what is in the world now by the same path hashes the snapshot was written with
+	TArray<UPrimitiveComponent *> props;
+	AGravityGun::GatherGrabbableComponents(world, props);
+	TMap<uint32, UPrimitiveComponent *> propsByHash;
+	propsByHash.Reserve(props.Num());
+	for (UPrimitiveComponent * prop : props)
+	{
+		propsByHash.Add(HashObjectPath(prop), prop);
+	}
+
+	TMap<uint32, AGravityGun *> gunsByHash;
+	for (TActorIterator<AGravityGun> gunIt(world); gunIt; ++gunIt)
+	{
+		gunsByHash.Add(HashObjectPath(*gunIt), *gunIt);
+	}
+
+	// Guns let go first so their physics handles don't drag props away from their restored transforms
+	const FGunRecord * gunRecords = reinterpret_cast<const FGunRecord *>(reinterpret_cast<const FPropRecord *>(header + 1) + header->NumProps);
+	for (uint32 gunIndex = 0; gunIndex < header->NumGuns; ++gunIndex)
+	{
+		if (AGravityGun * gun = gunsByHash.FindRef(gunRecords[gunIndex].PathHash))
+		{
+			gun->RestoreGrab(nullptr, FVector::ZeroVector);
+		}
+	}
+
+	// Props released just now, or still settling from before, would otherwise be slept or switched to static on the settle
+	// manager's schedule and every restore would no longer start from the same state. Only the props that were settling
+	// when the snapshot was captured are watched again, below
+	APropSettleManager * settleManager = APropSettleManager::Get(world);
+	if (settleManager)
+	{
+		settleManager->UnregisterAllProps();
+	}
+
+	int32 numPropsRestored = 0;
+	const FPropRecord * propRecords = reinterpret_cast<const FPropRecord *>(header + 1);
+	for (uint32 propIndex = 0; propIndex < header->NumProps; ++propIndex)
+	{
+		const FPropRecord & record = propRecords[propIndex];
+		UPrimitiveComponent * prop = propsByHash.FindRef(record.PathHash);
+		if (prop == nullptr)
+		{
+			continue;
+		}
+
+		const bool bSimulating = (record.Flags & PropFlag_Simulating) != 0;
+		if (prop->IsSimulatingPhysics() != bSimulating)
+		{
+			prop->SetSimulatePhysics(bSimulating);
+		}
+
+		const FQuat rotation(record.Rotation[0], record.Rotation[1], record.Rotation[2], record.Rotation[3]);
+		prop->SetWorldLocationAndRotation(UnpackVector(record.Location), rotation, false, nullptr, ETeleportType::TeleportPhysics);
+
+		if (bSimulating)
+		{
+			prop->SetPhysicsLinearVelocity(UnpackVector(record.LinearVelocity));
+			prop->SetPhysicsAngularVelocityInDegrees(UnpackVector(record.AngularVelocity));
+			if (record.Flags & PropFlag_Awake)
+			{
+				prop->WakeRigidBody();
+			}
+			else
+			{
+				prop->PutRigidBodyToSleep();
+			}
+
+			if (settleManager && (record.Flags & PropFlag_Settling))
+			{
+				settleManager->RegisterReleasedProp(prop, (record.Flags & PropFlag_RestoreStatic) != 0);
+			}
+		}
+		++numPropsRestored;
+	}
+
+	// Now that props are back in place guns can pick their objects up again
+	for (uint32 gunIndex = 0; gunIndex < header->NumGuns; ++gunIndex)
+	{
+		const FGunRecord & record = gunRecords[gunIndex];
+		AGravityGun * gun = gunsByHash.FindRef(record.PathHash);
+		UPrimitiveComponent * grabbedComponent = propsByHash.FindRef(record.GrabbedPathHash);
+		if (gun && grabbedComponent)
+		{
+			gun->RestoreGrab(grabbedComponent, UnpackVector(record.HandleLocation), (record.Flags & GunFlag_RestoreGrabbedStatic) != 0);
+		}
+	}
+
+	UE_LOG(LogPhysicsSnapshot, Log, TEXT("Restored %d of %u props from %s in %.2f ms"), numPropsRestored, header->NumProps, *fullPath, (FPlatformTime::Seconds() - startTime) * 1000.0);
+	return true;
+}
+
+// Console access so benchmark and repro scripts can use snapshots without any Blueprint setup
+static FAutoConsoleCommandWithWorldAndArgs GCapturePhysicsSnapshotCommand(
+	TEXT("GravityGun.CaptureSnapshot"),
+	TEXT("Captures all grabbable props and gravity guns to a snapshot file. Usage: GravityGun.CaptureSnapshot <File>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString> & args, UWorld * world)
+	{
+		UPhysicsSnapshotLibrary::CapturePhysicsSnapshot(world, args.Num() > 0 ? args[0] : TEXT("Default.snapshot"));
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GRestorePhysicsSnapshotCommand(
+	TEXT("GravityGun.RestoreSnapshot"),
+	TEXT("Restores grabbable props and gravity guns from a snapshot file. Usage: GravityGun.RestoreSnapshot <File>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString> & args, UWorld * world)
+	{
+		UPhysicsSnapshotLibrary::RestorePhysicsSnapshot(world, args.Num() > 0 ? args[0] : TEXT("Default.snapshot"));
+	}));
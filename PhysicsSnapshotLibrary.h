@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "PhysicsSnapshotLibrary.generated.h"
+
+/**
+ *  Captures and restores the physical state of every grabbable prop and every gravity gun in a world
+ *  Snapshots are flat binary files made of a header followed by fixed-size records, so they can be memory-mapped and read in place
+ *  Used to start benchmark iterations and bug repros from identical states without reloading the map
+ */
+UCLASS()
+class GRAVITYGUNPROJECT_API UPhysicsSnapshotLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	// Writes the transform, velocity and sleep state of all grabbable props and the held state of all gravity guns to a file
+	// Relative paths are placed in the project's Saved/Snapshots directory
+	UFUNCTION(BlueprintCallable, Category = "Physics Snapshot", meta = (WorldContext = "WorldContextObject"))
+	static bool CapturePhysicsSnapshot(UObject * WorldContextObject, const FString & FilePath);
+
+	// Puts every prop and gravity gun recorded in the file back into its recorded state, anything not in the file is left untouched
+	UFUNCTION(BlueprintCallable, Category = "Physics Snapshot", meta = (WorldContext = "WorldContextObject"))
+	static bool RestorePhysicsSnapshot(UObject * WorldContextObject, const FString & FilePath);
+};
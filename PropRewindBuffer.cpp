@@ -0,0 +1,270 @@
+#include "PropRewindBuffer.h"
+#include "GravityGun.h"
+#include "GravityGunWorldManager.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+
+APropRewindBuffer::APropRewindBuffer()
+{
+	// Record after physics so each frame holds where the props ended up that frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+}
+
+APropRewindBuffer * APropRewindBuffer::Get(UWorld * world)
+{
+	return GetOrSpawnWorldManager<APropRewindBuffer>(world);
+}
+
+void APropRewindBuffer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Allocate the whole history up front, nothing is allocated while recording
+	RewindDepth = FMath::Clamp(RewindDepth, 2, 256);
+	MaxTrackedProps = FMath::Max(MaxTrackedProps, 1);
+
+	const int32 numEntries = RewindDepth * MaxTrackedProps;
+	FrameTimestamps.SetNumZeroed(RewindDepth);
+	BoundsOrigins.SetNumZeroed(numEntries);
+	BoundsExtents.Init(FVector(-1.0f), numEntries);
+	Locations.SetNumZeroed(numEntries);
+	Rotations.Init(FQuat::Identity, numEntries);
+	TrackedProps.Reserve(MaxTrackedProps);
+
+	// Only the server rewinds traces, clients have no use for the history
+	if (GetNetMode() == NM_Client)
+	{
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	RefreshTrackedProps();
+}
+
+void APropRewindBuffer::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Searching the world for props is comparatively expensive so it only happens every so often
+	TimeUntilPropRefresh -= DeltaSeconds;
+	if (TimeUntilPropRefresh <= 0.0f)
+	{
+		RefreshTrackedProps();
+	}
+
+	RecordFrame();
+}
+
+void APropRewindBuffer::RefreshTrackedProps()
+{
+	TimeUntilPropRefresh = PropRefreshInterval;
+
+	TArray<UPrimitiveComponent *> props;
+	AGravityGun::GatherGrabbableComponents(GetWorld(), props);
+
+	// Props that still exist keep their slot, the slots of destroyed props become free
+	TSet<UPrimitiveComponent *> alreadyTrackedProps;
+	alreadyTrackedProps.Reserve(TrackedProps.Num());
+	for (TWeakObjectPtr<UPrimitiveComponent> & trackedProp : TrackedProps)
+	{
+		if (trackedProp.IsValid())
+		{
+			alreadyTrackedProps.Add(trackedProp.Get());
+		}
+		else
+		{
+			trackedProp.Reset();
+		}
+	}
+
+	int32 freeSlot = 0;
+	for (UPrimitiveComponent * prop : props)
+	{
+		if (alreadyTrackedProps.Contains(prop))
+		{
+			continue;
+		}
+
+		while (freeSlot < TrackedProps.Num() && TrackedProps[freeSlot].IsValid())
+		{
+			++freeSlot;
+		}
+
+		if (freeSlot == TrackedProps.Num())
+		{
+			// Out of slots, any remaining props are simply not rewound
+			if (TrackedProps.Num() == MaxTrackedProps)
+			{
+				break;
+			}
+			TrackedProps.AddDefaulted();
+		}
+
+		TrackedProps[freeSlot] = prop;
+		ClearSlotHistory(freeSlot);
+	}
+}
+
+void APropRewindBuffer::RecordFrame()
+{
+	NewestFrame = (NewestFrame + 1) % RewindDepth;
+	NumRecordedFrames = FMath::Min(NumRecordedFrames + 1, RewindDepth);
+	FrameTimestamps[NewestFrame] = GetWorld()->GetTimeSeconds();
+
+	const int32 frameStart = NewestFrame * MaxTrackedProps;
+	for (int32 slot = 0; slot < TrackedProps.Num(); ++slot)
+	{
+		const int32 entry = frameStart + slot;
+		if (UPrimitiveComponent * prop = TrackedProps[slot].Get())
+		{
+			BoundsOrigins[entry] = prop->Bounds.Origin;
+			BoundsExtents[entry] = prop->Bounds.BoxExtent;
+			Locations[entry] = prop->GetComponentLocation();
+			Rotations[entry] = prop->GetComponentQuat();
+		}
+		else
+		{
+			BoundsExtents[entry] = FVector(-1.0f);
+		}
+	}
+}
+
+void APropRewindBuffer::ClearSlotHistory(int32 slot)
+{
+	for (int32 frame = 0; frame < RewindDepth; ++frame)
+	{
+		BoundsExtents[frame * MaxTrackedProps + slot] = FVector(-1.0f);
+	}
+}
+
+bool APropRewindBuffer::RewindLineTrace(const FVector & traceStart, const FVector & traceEnd, float timestamp, FHitResult & outHitResult) const
+{
+	const FVector traceDelta = traceEnd - traceStart;
+	const FCollisionQueryParams queryParams(FName(TEXT("RewindLineTrace")), false);
+
+	bool bBlockingHit = false;
+	float closestHitTime = 1.0f;
+
+	// Start of the two frames either side of the timestamp, none until the first frame has been recorded
+	int32 olderFrameStart = INDEX_NONE;
+	int32 newerFrameStart = INDEX_NONE;
+
+	if (NumRecordedFrames > 0)
+	{
+		// Walk back from the newest frame to find the two frames either side of the timestamp
+		int32 olderFrame = INDEX_NONE;
+		int32 newerFrame = INDEX_NONE;
+		for (int32 frameAge = 0; frameAge < NumRecordedFrames; ++frameAge)
+		{
+			const int32 frame = (NewestFrame - frameAge + RewindDepth) % RewindDepth;
+			if (FrameTimestamps[frame] <= timestamp)
+			{
+				olderFrame = frame;
+				break;
+			}
+			newerFrame = frame;
+		}
+
+		// Older than the history covers, clamp to the oldest frame
+		if (olderFrame == INDEX_NONE)
+		{
+			olderFrame = newerFrame;
+		}
+		// Newer than the newest frame, use the newest frame as is
+		if (newerFrame == INDEX_NONE)
+		{
+			newerFrame = olderFrame;
+		}
+
+		const float frameDuration = FrameTimestamps[newerFrame] - FrameTimestamps[olderFrame];
+		const float alpha = frameDuration > 0.0f ? FMath::Clamp((timestamp - FrameTimestamps[olderFrame]) / frameDuration, 0.0f, 1.0f) : 0.0f;
+
+		olderFrameStart = olderFrame * MaxTrackedProps;
+		newerFrameStart = newerFrame * MaxTrackedProps;
+
+		for (int32 slot = 0; slot < TrackedProps.Num(); ++slot)
+		{
+			const int32 olderEntry = olderFrameStart + slot;
+			const int32 newerEntry = newerFrameStart + slot;
+
+			// Broad phase against a box enclosing the prop in both frames, this only touches the packed bounds arrays
+			const FVector & olderExtent = BoundsExtents[olderEntry];
+			const FVector & newerExtent = BoundsExtents[newerEntry];
+			if (olderExtent.X < 0.0f || newerExtent.X < 0.0f)
+			{
+				continue;
+			}
+
+			FBox rewoundBounds(BoundsOrigins[olderEntry] - olderExtent, BoundsOrigins[olderEntry] + olderExtent);
+			rewoundBounds += FBox(BoundsOrigins[newerEntry] - newerExtent, BoundsOrigins[newerEntry] + newerExtent);
+			if (FMath::LineBoxIntersection(rewoundBounds, traceStart, traceEnd, traceDelta) == false)
+			{
+				continue;
+			}
+
+			UPrimitiveComponent * prop = TrackedProps[slot].Get();
+			if (prop == nullptr)
+			{
+				continue;
+			}
+
+			// Narrow phase, instead of moving the prop back in time the trace is moved into the prop's current space,
+			// which leaves the physics scene untouched
+			const FTransform rewoundTransform(FQuat::Slerp(Rotations[olderEntry], Rotations[newerEntry], alpha), FMath::Lerp(Locations[olderEntry], Locations[newerEntry], alpha), prop->GetComponentScale());
+			const FTransform & currentTransform = prop->GetComponentTransform();
+			const FVector shiftedStart = currentTransform.TransformPosition(rewoundTransform.InverseTransformPosition(traceStart));
+			const FVector shiftedEnd = currentTransform.TransformPosition(rewoundTransform.InverseTransformPosition(traceEnd));
+
+			FHitResult propHit;
+			if (prop->LineTraceComponent(propHit, shiftedStart, shiftedEnd, queryParams) && propHit.Time < closestHitTime)
+			{
+				// Move the hit back to where the prop was at the rewound time
+				propHit.Location = rewoundTransform.TransformPosition(currentTransform.InverseTransformPosition(propHit.Location));
+				propHit.ImpactPoint = rewoundTransform.TransformPosition(currentTransform.InverseTransformPosition(propHit.ImpactPoint));
+				propHit.Normal = rewoundTransform.TransformVectorNoScale(currentTransform.InverseTransformVectorNoScale(propHit.Normal));
+				propHit.ImpactNormal = rewoundTransform.TransformVectorNoScale(currentTransform.InverseTransformVectorNoScale(propHit.ImpactNormal));
+				propHit.TraceStart = traceStart;
+				propHit.TraceEnd = traceEnd;
+				propHit.Distance = propHit.Time * traceDelta.Size();
+
+				outHitResult = propHit;
+				closestHitTime = propHit.Time;
+				bBlockingHit = true;
+			}
+		}
+	}
+
+	// Anything without history for these frames, i.e. props that did not fit in the table, props that only just appeared
+	// and any other blocker the normal grab trace would hit, is traced where it is now and the nearest hit overall wins
+	TArray<TEnumAsByte<EObjectTypeQuery>> acceptedObjectTypes;
+	AGravityGun::GetGrabbableObjectTypes(acceptedObjectTypes);
+
+	TArray<FHitResult> currentHits;
+	GetWorld()->LineTraceMultiByObjectType(currentHits, traceStart, traceEnd, FCollisionObjectQueryParams(acceptedObjectTypes), queryParams);
+	for (const FHitResult & currentHit : currentHits)
+	{
+		if (currentHit.Time >= closestHitTime || HasRewoundHistory(currentHit.Component.Get(), olderFrameStart, newerFrameStart))
+		{
+			continue;
+		}
+
+		outHitResult = currentHit;
+		outHitResult.bBlockingHit = true;
+		closestHitTime = currentHit.Time;
+		bBlockingHit = true;
+	}
+
+	return bBlockingHit;
+}
+
+bool APropRewindBuffer::HasRewoundHistory(const UPrimitiveComponent * component, int32 olderFrameStart, int32 newerFrameStart) const
+{
+	if (component == nullptr || olderFrameStart == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const int32 slot = TrackedProps.IndexOfByPredicate([component](const TWeakObjectPtr<UPrimitiveComponent> & trackedProp) { return trackedProp.Get() == component; });
+	return slot != INDEX_NONE && BoundsExtents[olderFrameStart + slot].X >= 0.0f && BoundsExtents[newerFrameStart + slot].X >= 0.0f;
+}
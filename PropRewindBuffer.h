@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "PropRewindBuffer.generated.h"
+
+class UPrimitiveComponent;
+
+/**
+ *  Server side history of where every grabbable prop was over the last few frames, used to lag compensate grab and push traces
+ *  Each frame is stored as flat arrays indexed by prop slot, so the broad phase only ever walks the packed bounds arrays
+ *  Memory use is fixed at RewindDepth * MaxTrackedProps entries, allocated once in BeginPlay
+ *  The buffer is spawned when the first remote player joins the server, so standalone games and servers nobody has joined
+ *  never record any history
+ */
+UCLASS(NotBlueprintable)
+class GRAVITYGUNPROJECT_API APropRewindBuffer : public AInfo
+{
+	GENERATED_BODY()
+
+private:
+	// Prop that owns each slot, slot indices are stable for as long as the prop exists
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> TrackedProps;
+
+	// World time each frame in the ring was recorded at
+	TArray<float> FrameTimestamps;
+
+	/* Per frame, per slot history laid out as [frame * MaxTrackedProps + slot] */
+	TArray<FVector> BoundsOrigins;
+
+	// A negative X extent marks a slot that had no prop in that frame
+	TArray<FVector> BoundsExtents;
+
+	TArray<FVector> Locations;
+
+	TArray<FQuat> Rotations;
+
+	// Ring position of the most recently recorded frame
+	int32 NewestFrame = INDEX_NONE;
+
+	int32 NumRecordedFrames = 0;
+
+	float TimeUntilPropRefresh = 0.0f;
+
+protected:
+	// Number of frames of history kept, the oldest frame is the furthest back a trace can be rewound
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rewind", meta = (ClampMin = "2", ClampMax = "256"))
+	int32 RewindDepth = 32;
+
+	// Maximum number of props recorded, props beyond this are traced at their current location
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rewind", meta = (ClampMin = "1"))
+	int32 MaxTrackedProps = 256;
+
+	// How often the world is searched for grabbable props that have appeared or disappeared
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind")
+	float PropRefreshInterval = 1.0f;
+
+public:
+	APropRewindBuffer();
+
+	// Returns the rewind buffer for this world, spawning one if needed
+	static APropRewindBuffer * Get(UWorld * world);
+
+	// Line trace against the grabbable props as they were at the given world time, anything without recorded history is
+	// traced where it is now. Times older than the recorded history are clamped to the oldest recorded frame
+	bool RewindLineTrace(const FVector & traceStart, const FVector & traceEnd, float timestamp, FHitResult & outHitResult) const;
+
+	// Begin AActor interface -------
+	virtual void Tick(float DeltaSeconds) override;
+	// End AActor interface -------
+
+protected:
+	// Begin AActor interface -------
+	virtual void BeginPlay() override;
+	// End AActor interface -------
+
+	// Hands out slots to new props and frees the slots of destroyed props
+	void RefreshTrackedProps();
+
+	// Appends the current transforms of all tracked props to the ring
+	void RecordFrame();
+
+private:
+	// Marks a slot as empty in every recorded frame so a new prop does not inherit the previous owner's history
+	void ClearSlotHistory(int32 slot);
+
+	// Whether the component has recorded history in both of the given frames, and so was already traced at its rewound transform
+	bool HasRewoundHistory(const UPrimitiveComponent * component, int32 olderFrameStart, int32 newerFrameStart) const;
+};
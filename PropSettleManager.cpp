@@ -0,0 +1,183 @@
+#include "PropSettleManager.h"
+#include "GravityGunWorldManager.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+
+APropSettleManager::APropSettleManager()
+{
+	// Only ticks while there are props to watch
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+}
+
+APropSettleManager * APropSettleManager::Get(UWorld * world)
+{
+	return GetOrSpawnWorldManager<APropSettleManager>(world);
+}
+
+void APropSettleManager::RegisterReleasedProp(UPrimitiveComponent * prop, bool bRestoreStaticOnSettle)
+{
+	if (prop == nullptr || prop->IsSimulatingPhysics() == false)
+	{
+		return;
+	}
+
+	// Released again before it settled, keep the existing entry but start the rest timer over
+	FSettlingProp * settlingProp = SettlingProps.FindByPredicate([prop](const FSettlingProp & entry) { return entry.Component.Get() == prop; });
+	if (settlingProp == nullptr)
+	{
+		settlingProp = &SettlingProps[SettlingProps.AddDefaulted()];
+		settlingProp->Component = prop;
+	}
+	settlingProp->TimeAtRest = 0.0f;
+	settlingProp->bRestoreStaticOnSettle |= bRestoreStaticOnSettle;
+
+	SetActorTickEnabled(true);
+}
+
+bool APropSettleManager::UnregisterProp(UPrimitiveComponent * prop)
+{
+	const int32 index = SettlingProps.IndexOfByPredicate([prop](const FSettlingProp & entry) { return entry.Component.Get() == prop; });
+	if (index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const bool bRestoreStaticOnSettle = SettlingProps[index].bRestoreStaticOnSettle;
+	SettlingProps.RemoveAtSwap(index);
+	return bRestoreStaticOnSettle;
+}
+
+bool APropSettleManager::IsWatchingProp(const UPrimitiveComponent * prop, bool & outRestoreStaticOnSettle) const
+{
+	const FSettlingProp * settlingProp = SettlingProps.FindByPredicate([prop](const FSettlingProp & entry) { return entry.Component.Get() == prop; });
+	outRestoreStaticOnSettle = settlingProp ? settlingProp->bRestoreStaticOnSettle : false;
+	return settlingProp != nullptr;
+}
+
+void APropSettleManager::UnregisterAllProps()
+{
+	SettlingProps.Reset();
+	TimeSinceLastCheck = 0.0f;
+	SetActorTickEnabled(false);
+}
+
+void APropSettleManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	TimeSinceLastCheck += DeltaSeconds;
+	if (TimeSinceLastCheck < CheckInterval)
+	{
+		return;
+	}
+	const float elapsedTime = TimeSinceLastCheck;
+	TimeSinceLastCheck = 0.0f;
+
+	const float restLinearSpeedSquared = FMath::Square(RestLinearSpeed);
+	const float restAngularSpeedSquared = FMath::Square(RestAngularSpeed);
+	const float budgetSleepSpeedSquared = FMath::Square(BudgetSleepSpeed);
+	const int32 maxAwakeProps = FMath::Max(MaxAwakeProps, 1);
+
+	AwakeProps.Reset();
+	PendingSettles.Reset();
+	int32 numAwakeProps = 0;
+
+	// Decide what happens to every prop first and only then remove anything, so indices stay valid throughout
+	for (int32 index = 0; index < SettlingProps.Num(); ++index)
+	{
+		FSettlingProp & settlingProp = SettlingProps[index];
+		UPrimitiveComponent * prop = settlingProp.Component.Get();
+
+		// Destroyed, grabbed by something else or switched off by gameplay
+		if (prop == nullptr || prop->IsSimulatingPhysics() == false)
+		{
+			PendingSettles.Add(FPendingSettle{ index, ESettleAction::StopWatching });
+			continue;
+		}
+
+		// Already asleep, put to sleep by physics on its own or by the budget on an earlier check, so it is resting
+		if (prop->RigidBodyIsAwake() == false)
+		{
+			PendingSettles.Add(FPendingSettle{ index, ESettleAction::Settle });
+			continue;
+		}
+
+		const float linearSpeedSquared = prop->GetPhysicsLinearVelocity().SizeSquared();
+		const bool bAtRest = linearSpeedSquared < restLinearSpeedSquared && prop->GetPhysicsAngularVelocityInDegrees().SizeSquared() < restAngularSpeedSquared;
+		settlingProp.TimeAtRest = bAtRest ? settlingProp.TimeAtRest + elapsedTime : 0.0f;
+		settlingProp.TimeBelowBudgetSpeed = linearSpeedSquared < budgetSleepSpeedSquared ? settlingProp.TimeBelowBudgetSpeed + elapsedTime : 0.0f;
+
+		if (settlingProp.TimeAtRest >= SettleTime)
+		{
+			PendingSettles.Add(FPendingSettle{ index, ESettleAction::Settle });
+			continue;
+		}
+
+		++numAwakeProps;
+		// Only props that were already slow on the previous check as well can be slept early, a single slow reading could
+		// just be the top of an arc
+		if (settlingProp.TimeBelowBudgetSpeed > elapsedTime)
+		{
+			AwakeProps.Add(FAwakeProp{ index, linearSpeedSquared });
+		}
+	}
+
+	// Over budget, put the slowest of the slow props to sleep first. They keep being watched and are settled on a later check
+	const int32 numOverBudget = FMath::Min(numAwakeProps - maxAwakeProps, AwakeProps.Num());
+	if (numOverBudget > 0)
+	{
+		AwakeProps.Sort([](const FAwakeProp & a, const FAwakeProp & b) { return a.SpeedSquared < b.SpeedSquared; });
+		for (int32 awakeIndex = 0; awakeIndex < numOverBudget; ++awakeIndex)
+		{
+			PendingSettles.Add(FPendingSettle{ AwakeProps[awakeIndex].Index, ESettleAction::PutToSleep });
+		}
+	}
+
+	// Settle from the highest index down so each swap only ever moves an entry that is staying. Props only put to sleep are
+	// never removed, so they don't disturb this either
+	PendingSettles.Sort([](const FPendingSettle & a, const FPendingSettle & b) { return a.Index > b.Index; });
+	for (const FPendingSettle & pendingSettle : PendingSettles)
+	{
+		SettleProp(pendingSettle.Index, pendingSettle.Action);
+	}
+
+	// Nothing left to watch, stop ticking until the next release
+	if (SettlingProps.Num() == 0)
+	{
+		SetActorTickEnabled(false);
+	}
+}
+
+void APropSettleManager::SettleProp(int32 index, ESettleAction action)
+{
+	const FSettlingProp & settlingProp = SettlingProps[index];
+	UPrimitiveComponent * prop = settlingProp.Component.Get();
+
+	// Gone or already taken out of simulation by something else, just stop watching it
+	if (action == ESettleAction::StopWatching || prop == nullptr || prop->IsSimulatingPhysics() == false)
+	{
+		SettlingProps.RemoveAtSwap(index);
+		return;
+	}
+
+	// Sleeping only, never switched to static here as the prop has not been at rest for the full settle time
+	if (action == ESettleAction::PutToSleep)
+	{
+		prop->PutRigidBodyToSleep();
+		return;
+	}
+
+	if (settlingProp.bRestoreStaticOnSettle && bRestoreStaticProps)
+	{
+		// No longer simulating is even cheaper than sleeping
+		prop->SetSimulatePhysics(false);
+	}
+	else
+	{
+		prop->PutRigidBodyToSleep();
+	}
+
+	SettlingProps.RemoveAtSwap(index);
+}
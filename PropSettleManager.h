@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "PropSettleManager.generated.h"
+
+class UPrimitiveComponent;
+
+/**
+ *  Watches props after the gravity gun lets go of them and returns them to a cheap state once they come to rest
+ *  Resting props are put to sleep sooner than the physics engine would on its own, and props that were only simulating because
+ *  they were grabbed can be switched back to not simulating. Over a budget of awake props, the slowest props are slept early
+ */
+UCLASS(NotBlueprintable)
+class GRAVITYGUNPROJECT_API APropSettleManager : public AInfo
+{
+	GENERATED_BODY()
+
+private:
+	struct FSettlingProp
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		// How long the prop has been below the rest thresholds
+		float TimeAtRest = 0.0f;
+		// How long the prop has been below the budget sleep speed
+		float TimeBelowBudgetSpeed = 0.0f;
+		// The prop was not simulating before it was grabbed, so it can stop simulating again once settled
+		bool bRestoreStaticOnSettle = false;
+	};
+
+	// Awake prop and its squared speed, used to pick which props to put to sleep when over budget
+	struct FAwakeProp
+	{
+		int32 Index;
+		float SpeedSquared;
+	};
+
+	enum class ESettleAction : uint8
+	{
+		// Just stop watching the prop
+		StopWatching,
+		// Put the prop into its resting state, switching it back to not simulating if it was static before the grab
+		Settle,
+		// Only put the prop to sleep, it stays simulating and is watched until it can be settled
+		PutToSleep,
+	};
+
+	// Prop whose settle action is applied at the end of a check
+	struct FPendingSettle
+	{
+		int32 Index;
+		ESettleAction Action;
+	};
+
+	TArray<FSettlingProp> SettlingProps;
+
+	/* Reused every check to avoid reallocating */
+	TArray<FAwakeProp> AwakeProps;
+
+	TArray<FPendingSettle> PendingSettles;
+
+	float TimeSinceLastCheck = 0.0f;
+
+protected:
+	// Props moving slower than this (cm/s) count as at rest
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settling")
+	float RestLinearSpeed = 5.0f;
+
+	// Props rotating slower than this (deg/s) count as at rest
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settling")
+	float RestAngularSpeed = 10.0f;
+
+	// How long a prop has to stay at rest before it is put to sleep
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settling")
+	float SettleTime = 0.5f;
+
+	// Switch props that were only simulating because they were grabbed back to not simulating once they settle
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settling")
+	bool bRestoreStaticProps = true;
+
+	// Maximum number of watched props allowed to be awake at once, counting every watched prop whatever its speed. Props
+	// the gravity gun never touched are not watched and so not counted. When over budget, the slowest props below
+	// BudgetSleepSpeed are put to sleep early until the count is back within budget
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settling", meta = (ClampMin = "1"))
+	int32 MaxAwakeProps = 64;
+
+	// Props moving slower than this (cm/s) on two checks in a row can be put to sleep when over budget. Much looser than
+	// RestLinearSpeed, but a prop in flight never stays this slow across two checks so nothing is frozen mid-air
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settling")
+	float BudgetSleepSpeed = 50.0f;
+
+	// Props are only checked this often rather than every frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settling")
+	float CheckInterval = 0.1f;
+
+public:
+	APropSettleManager();
+
+	// Returns the settle manager for this world, spawning one if needed
+	static APropSettleManager * Get(UWorld * world);
+
+	// Start watching a prop that was just released or launched
+	void RegisterReleasedProp(UPrimitiveComponent * prop, bool bRestoreStaticOnSettle);
+
+	// Stop watching a prop, returns whether it was going to be switched back to not simulating
+	bool UnregisterProp(UPrimitiveComponent * prop);
+
+	// Whether the prop is being watched, and if so whether it will be switched back to not simulating once it settles
+	bool IsWatchingProp(const UPrimitiveComponent * prop, bool & outRestoreStaticOnSettle) const;
+
+	// Stop watching every prop without touching any of them, e.g. when their state is being restored from elsewhere
+	void UnregisterAllProps();
+
+	FORCEINLINE int32 GetNumSettlingProps() const { return SettlingProps.Num(); }
+
+	// Begin AActor interface -------
+	virtual void Tick(float DeltaSeconds) override;
+	// End AActor interface -------
+
+private:
+	// Applies the settle action to the prop, removing it from the watched props unless it is only put to sleep
+	void SettleProp(int32 index, ESettleAction action);
+};
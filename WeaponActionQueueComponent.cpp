@@ -0,0 +1,109 @@
+#include "WeaponActionQueueComponent.h"
+#include "Engine/World.h"
+
+UWeaponActionQueueComponent::UWeaponActionQueueComponent()
+{
+	// Process before physics so impulses from this frame's actions are simulated this frame, and only while actions are queued
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+}
+
+void UWeaponActionQueueComponent::QueueAction(EWeaponAction action, float actionTimestamp)
+{
+	// Already waiting to be performed, nothing to add
+	if (QueuedActions.ContainsByPredicate([action](const FQueuedAction & queuedAction) { return queuedAction.Action == action; }))
+	{
+		return;
+	}
+
+	FQueuedAction queuedAction;
+	queuedAction.Action = action;
+	queuedAction.TimeQueued = GetWorld()->GetTimeSeconds();
+	queuedAction.ActionTimestamp = actionTimestamp;
+	QueuedActions.Add(queuedAction);
+
+	if (IsComponentTickEnabled() == false)
+	{
+		// Start stepping from now rather than from whenever the queue last ran dry, with one step already owed so the
+		// action is performed on the next tick however short that frame is
+		StepAccumulator = FixedStepSeconds;
+		SetComponentTickEnabled(true);
+	}
+}
+
+void UWeaponActionQueueComponent::SetWeapon(ABaseWeapon * newWeapon)
+{
+	Weapon = newWeapon;
+	QueuedActions.Reset();
+	// Cooldowns belong to the weapon that set them, a newly picked up weapon can act straight away
+	NextPrimaryActionTime = 0.0f;
+	NextSecondaryActionTime = 0.0f;
+}
+
+void UWeaponActionQueueComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction * ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Time beyond the step budget is thrown away, which bounds the number of steps and so actions in a frame
+	StepAccumulator = FMath::Min(StepAccumulator + DeltaTime, FixedStepSeconds * MaxStepsPerFrame);
+
+	const float frameTime = GetWorld()->GetTimeSeconds();
+	while (StepAccumulator >= FixedStepSeconds && QueuedActions.Num() > 0)
+	{
+		StepAccumulator -= FixedStepSeconds;
+		// Steps are spread back over the frame so cooldowns are measured in step time rather than frame time
+		ProcessStep(frameTime - StepAccumulator);
+	}
+
+	// Queue ran dry, stop ticking until the next input
+	if (QueuedActions.Num() == 0)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UWeaponActionQueueComponent::ProcessStep(float currentTime)
+{
+	for (int32 index = 0; index < QueuedActions.Num(); ++index)
+	{
+		const FQueuedAction queuedAction = QueuedActions[index];
+
+		// Too old to still feel like a response to the input
+		if (currentTime - queuedAction.TimeQueued > MaxQueuedTime)
+		{
+			QueuedActions.RemoveAt(index);
+			--index;
+			continue;
+		}
+
+		float & nextActionTime = queuedAction.Action == EWeaponAction::Primary ? NextPrimaryActionTime : NextSecondaryActionTime;
+		if (currentTime < nextActionTime)
+		{
+			continue;
+		}
+
+		QueuedActions.RemoveAt(index);
+
+		ABaseWeapon * weapon = Weapon.Get();
+		nextActionTime = currentTime + (weapon ? weapon->GetActionCooldown(queuedAction.Action) : 0.0f);
+		if (weapon)
+		{
+			// Only set for the duration of the action, so nothing else the weapon does is mistaken for a remote action
+			weapon->SetActionTimestamp(queuedAction.ActionTimestamp);
+			if (queuedAction.Action == EWeaponAction::Primary)
+			{
+				weapon->PrimaryWeaponAction();
+			}
+			else
+			{
+				weapon->SecondaryWeaponAction();
+			}
+			weapon->SetActionTimestamp(-1.0f);
+		}
+		OnWeaponActionPerformed.Broadcast(queuedAction.Action);
+
+		// One action per step
+		return;
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "BaseWeapon.h"
+#include "WeaponActionQueueComponent.generated.h"
+
+// Broadcast after a queued action has been performed on the weapon
+DECLARE_MULTICAST_DELEGATE_OneParam(FWeaponActionPerformedDelegate, EWeaponAction);
+
+/**
+ *  Sits between a character's input and its weapon so bursts of input can't do redundant work
+ *  Repeated presses of an action that is already queued are merged into one, actions are performed at a fixed step before
+ *  physics with at most one action per step, and each action waits for the weapon's cooldown for that action
+ */
+UCLASS(ClassGroup = (Weapon), meta = (BlueprintSpawnableComponent))
+class GRAVITYGUNPROJECT_API UWeaponActionQueueComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+private:
+	struct FQueuedAction
+	{
+		EWeaponAction Action;
+		float TimeQueued;
+		// Server world time a remote client issued the action at, negative for local input
+		float ActionTimestamp;
+	};
+
+	// At most one entry per action type, in the order they were first pressed
+	TArray<FQueuedAction, TInlineAllocator<2>> QueuedActions;
+
+	// Weapon the actions are performed on, may be null in which case only the performed delegate fires
+	TWeakObjectPtr<ABaseWeapon> Weapon;
+
+	// World time at which each action type may next be performed
+	float NextPrimaryActionTime = 0.0f;
+
+	float NextSecondaryActionTime = 0.0f;
+
+	// Time not yet consumed by whole steps
+	float StepAccumulator = 0.0f;
+
+protected:
+	// Length of one processing step in seconds
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Actions")
+	float FixedStepSeconds = 1.0f / 60.0f;
+
+	// Upper bound on the steps run in one frame, so a long frame cannot cause a burst of actions
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Actions", meta = (ClampMin = "1"))
+	int32 MaxStepsPerFrame = 4;
+
+	// Queued actions still waiting on their cooldown after this long are dropped rather than performed late
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Actions")
+	float MaxQueuedTime = 0.2f;
+
+public:
+	FWeaponActionPerformedDelegate OnWeaponActionPerformed;
+
+public:
+	UWeaponActionQueueComponent();
+
+	// Queue an action from input, merged with an already queued action of the same type
+	// Actions sent to the server by a remote client pass the server world time they were issued at, so the weapon can lag compensate them
+	void QueueAction(EWeaponAction action, float actionTimestamp = -1.0f);
+
+	// Changes the weapon actions are performed on and drops anything queued for the previous one along with its cooldowns
+	void SetWeapon(ABaseWeapon * newWeapon);
+
+	// Begin UActorComponent interface -------
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction * ThisTickFunction) override;
+	// End UActorComponent interface -------
+
+protected:
+	// Performs at most one queued action whose cooldown has elapsed
+	void ProcessStep(float currentTime);
+};